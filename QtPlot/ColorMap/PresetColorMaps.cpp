@@ -0,0 +1,206 @@
+#include "PresetColorMaps.h"
+
+#include "Interval.h"
+
+#include <limits>
+
+
+namespace
+{
+	const int TableSize = 4096;
+
+	struct ColorTable
+	{
+		QRgb colors[TableSize];
+	};
+
+	constexpr double clamp01(double value)
+	{
+		return value < 0.0 ? 0.0 : (value > 1.0 ? 1.0 : value);
+	}
+
+	constexpr double abs(double value)
+	{
+		return value < 0.0 ? -value : value;
+	}
+
+	constexpr QRgb pack(double r, double g, double b)
+	{
+		return 0xff000000u
+			| (static_cast<QRgb>(clamp01(r) * 255.0 + 0.5) << 16)
+			| (static_cast<QRgb>(clamp01(g) * 255.0 + 0.5) << 8)
+			| static_cast<QRgb>(clamp01(b) * 255.0 + 0.5);
+	}
+
+	constexpr double polynomial6(double x, double c0, double c1, double c2, double c3, double c4, double c5, double c6)
+	{
+		return c0 + x * (c1 + x * (c2 + x * (c3 + x * (c4 + x * (c5 + x * c6)))));
+	}
+
+	//polynomial fits of the matplotlib colormaps
+	struct Viridis
+	{
+		static constexpr QRgb color(double x)
+		{
+			return pack(
+				polynomial6(x, 0.2777273272234177, 0.1050930431085774, -0.3308618287255563, -4.634230498983486, 6.228269936347081, 4.776384997670288, -5.435455855934631),
+				polynomial6(x, 0.005407344544966578, 1.404613529898575, 0.214847559468213, -5.799100973351585, 14.17993336680509, -13.74514537774601, 4.645852612178535),
+				polynomial6(x, 0.3340998053353061, 1.384590162594685, 0.09509516302823659, -19.33244095627987, 56.69055260068105, -65.35303263337234, 26.3124352495832));
+		}
+	};
+
+	struct Inferno
+	{
+		static constexpr QRgb color(double x)
+		{
+			return pack(
+				polynomial6(x, 0.0002189403691192265, 0.1065134194856116, 11.60249308247187, -41.70399613139459, 77.162935699427, -71.31942824499214, 25.13112622477341),
+				polynomial6(x, 0.001651004631001012, 0.5639564367884091, -3.972853965665698, 17.43639888205313, -33.40235894210092, 32.62606426397723, -12.24266895238567),
+				polynomial6(x, -0.01948089843709184, 3.932712388889277, -15.9423941062914, 44.35414519872813, -81.80730925738993, 73.20951985803202, -23.07032500287172));
+		}
+	};
+
+	//polynomial approximation of Google Turbo
+	struct Turbo
+	{
+		static constexpr QRgb color(double x)
+		{
+			return pack(
+				polynomial6(x, 0.13572138, 4.61539260, -42.66032258, 132.13108234, -152.94239396, 59.28637943, 0.0),
+				polynomial6(x, 0.09140261, 2.19418839, 4.84296658, -14.18503333, 4.27729857, 2.82956604, 0.0),
+				polynomial6(x, 0.10667330, 12.64194608, -60.58204836, 110.36276771, -89.90310912, 27.34824973, 0.0));
+		}
+	};
+
+	struct Jet
+	{
+		static constexpr QRgb color(double x)
+		{
+			return pack(1.5 - abs(4.0 * x - 3.0), 1.5 - abs(4.0 * x - 2.0), 1.5 - abs(4.0 * x - 1.0));
+		}
+	};
+
+	struct Gray
+	{
+		static constexpr QRgb color(double x)
+		{
+			return pack(x, x, x);
+		}
+	};
+
+	template<class Map>
+	constexpr ColorTable makeTable()
+	{
+		ColorTable table = {};
+		for (int i = 0; i < TableSize; i++)
+		{
+			table.colors[i] = Map::color(i / static_cast<double>(TableSize - 1));
+		}
+		return table;
+	}
+
+	constexpr ColorTable viridisTable = makeTable<Viridis>();
+	constexpr ColorTable infernoTable = makeTable<Inferno>();
+	constexpr ColorTable turboTable = makeTable<Turbo>();
+	constexpr ColorTable jetTable = makeTable<Jet>();
+	constexpr ColorTable grayTable = makeTable<Gray>();
+}
+
+
+TableColorMap::TableColorMap(const QRgb* table, int tableSize)
+	: WfColorMap(RGB),
+	m_table(table),
+	m_tableSize(tableSize),
+	m_hasAlpha(false)
+{
+	for (int i = 0; i < m_tableSize; i++)
+	{
+		if (qAlpha(m_table[i]) != 255)
+		{
+			m_hasAlpha = true;
+			break;
+		}
+	}
+}
+
+QRgb TableColorMap::rgb(const QtInterval& interval, double value) const
+{
+	QRgb color;
+	lookupRow(interval, &value, &color, 1, activeTable(), m_tableSize);
+
+	return color;
+}
+
+double TableColorMap::RGB2Double(const QtInterval& interval, QRgb color) const
+{
+	if (interval.width() <= 0.0)
+		return std::numeric_limits<double>::quiet_NaN();
+
+	return reverseLookup(color);
+}
+
+void TableColorMap::rgbRow(const QtInterval& interval, const double* values, QRgb* colors, int count) const
+{
+	lookupRow(interval, values, colors, count, activeTable(), m_tableSize);
+}
+
+void TableColorMap::palette(QRgb* colors, int count) const
+{
+	resampleTable(activeTable(), m_tableSize, colors, count);
+}
+
+const QRgb* TableColorMap::lookupTable(int* size) const
+{
+	if (size)
+		*size = m_tableSize;
+
+	return activeTable();
+}
+
+void TableColorMap::updateLookupTable()
+{
+	const bool shaped = transform() == Gamma || transform() == Sqrt;
+	const bool premultiply = isPremultiplied() && m_hasAlpha;
+
+	invalidateReverseLookup();
+
+	if (!shaped && !premultiply)
+	{
+		m_shaped.clear();
+		return;
+	}
+
+	m_shaped.resize(m_tableSize);
+
+	const double maxIndex = m_tableSize - 1;
+	for (int i = 0; i < m_tableSize; i++)
+	{
+		const int index = shaped ? static_cast<int>(shapeRatio(i / maxIndex) * maxIndex + 0.5) : i;
+		m_shaped[i] = premultiply ? qPremultiply(m_table[index]) : m_table[index];
+	}
+}
+
+ViridisColorMap::ViridisColorMap()
+	: TableColorMap(viridisTable.colors, TableSize)
+{
+}
+
+InfernoColorMap::InfernoColorMap()
+	: TableColorMap(infernoTable.colors, TableSize)
+{
+}
+
+TurboColorMap::TurboColorMap()
+	: TableColorMap(turboTable.colors, TableSize)
+{
+}
+
+JetColorMap::JetColorMap()
+	: TableColorMap(jetTable.colors, TableSize)
+{
+}
+
+GrayColorMap::GrayColorMap()
+	: TableColorMap(grayTable.colors, TableSize)
+{
+}
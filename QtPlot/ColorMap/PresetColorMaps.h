@@ -0,0 +1,76 @@
+#pragma once
+
+#include "QtPlotGlobal.h"
+#include "WfColorMap.h"
+
+#include <QVector>
+
+
+/*!
+\brief Color map backed by a fixed color table
+
+rgb() and rgbRow() are a normalization and a table fetch.
+The table is not copied and must outlive the color map,
+a gamma or sqrt transform and premultiplied alpha are baked into a private remapped copy.
+*/
+class QTPLOT_EXPORT TableColorMap : public WfColorMap
+{
+public:
+	TableColorMap(const QRgb* table, int tableSize);
+
+	virtual QRgb rgb(const QtInterval& interval, double value) const override;
+	virtual double RGB2Double(const QtInterval& interval, QRgb color) const override;
+
+	virtual void rgbRow(const QtInterval& interval,
+		const double* values, QRgb* colors, int count) const override;
+
+	virtual void palette(QRgb* colors, int count) const override;
+
+	inline const QRgb* table() const { return m_table; }
+	inline int tableSize() const { return m_tableSize; }
+
+protected:
+	virtual void updateLookupTable() override;
+	virtual const QRgb* lookupTable(int* size) const override;
+
+private:
+	inline const QRgb* activeTable() const { return m_shaped.isEmpty() ? m_table : m_shaped.constData(); }
+
+	const QRgb* m_table;
+	int m_tableSize;
+	bool m_hasAlpha;
+	QVector<QRgb> m_shaped;
+};
+
+/*
+	Standard colormaps, the 4096 entry tables are generated at compile time.
+*/
+class QTPLOT_EXPORT ViridisColorMap : public TableColorMap
+{
+public:
+	ViridisColorMap();
+};
+
+class QTPLOT_EXPORT InfernoColorMap : public TableColorMap
+{
+public:
+	InfernoColorMap();
+};
+
+class QTPLOT_EXPORT TurboColorMap : public TableColorMap
+{
+public:
+	TurboColorMap();
+};
+
+class QTPLOT_EXPORT JetColorMap : public TableColorMap
+{
+public:
+	JetColorMap();
+};
+
+class QTPLOT_EXPORT GrayColorMap : public TableColorMap
+{
+public:
+	GrayColorMap();
+};
@@ -0,0 +1,50 @@
+#include "WfColorGradient.h"
+
+#include <QMap>
+#include <QVector>
+
+
+QCPColorGradient WfColorGradient::fromColorMap(const WfColorMap& colorMap, int levels)
+{
+	levels = qMax(2, levels);
+
+	QVector<QRgb> colors(levels);
+	colorMap.palette(colors.data(), levels);
+
+	const bool premultiplied = colorMap.isPremultiplied();
+
+	//stops on the level positions, the gradient color buffer is the palette itself
+	QMap<double, QColor> stops;
+	for (int i = 0; i < levels; i++)
+	{
+		const QRgb color = premultiplied ? qUnpremultiply(colors[i]) : colors[i];
+		stops.insert(static_cast<double>(i) / (levels - 1), QColor::fromRgba(color));
+	}
+
+	QCPColorGradient gradient;
+	gradient.setColorInterpolation(QCPColorGradient::ciRGB);
+	gradient.setColorStops(stops);
+	gradient.setLevelCount(levels);
+
+	//transformRow puts NaN on the first index
+	gradient.setNanHandling(QCPColorGradient::nhLowestColor);
+
+	return gradient;
+}
+
+QCPRange WfColorGradient::range(const WfColorMap& colorMap, const QtInterval& interval, bool* logarithmic)
+{
+	const bool logTransform = colorMap.transform() == WfColorMap::Log10 || colorMap.transform() == WfColorMap::Decibel;
+
+	if (logarithmic)
+	{
+		*logarithmic = logTransform;
+	}
+
+	if (!logTransform)
+	{
+		return QCPRange(interval.minValue(), interval.maxValue());
+	}
+
+	return QCPRange(colorMap.inverseTransformValue(interval.minValue()), colorMap.inverseTransformValue(interval.maxValue()));
+}
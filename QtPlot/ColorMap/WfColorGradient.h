@@ -0,0 +1,35 @@
+#pragma once
+
+#include "QtPlotGlobal.h"
+#include "QCustomPlot/QCustomPlot.h"
+#include "WfColorMap.h"
+
+
+/*!
+\brief Bridge from WfColorMap to QCPColorGradient
+
+The baked palette of a map (transform shaping and all) becomes the color buffer of a gradient,
+one stop per level, so QCPColorMap, QCPColorScale and QCPColorGradient::colorize() use the same table
+the waterfall indexes into.
+
+QCustomPlot only knows linear and natural log ranges: a Log10 or Decibel map is exported
+as a logarithmic range over the raw values, the other transforms keep the interval as is.
+QCPColorGradient truncates positions to levels where the waterfall rounds them, the difference is below one level.
+*/
+class QTPLOT_EXPORT WfColorGradient
+{
+public:
+	//level count of a default QCPColorGradient
+	enum { DefaultLevels = 350 };
+
+	static QCPColorGradient fromColorMap(const WfColorMap& colorMap, int levels = DefaultLevels);
+
+	/*!
+	\brief Data range for QCPColorGradient::colorize() matching an interval of the map
+
+	\param colorMap Color map the gradient was made from.
+	\param interval Interval in the transformed unit, as given to the waterfall.
+	\param logarithmic Set to the 'logarithmic' argument of colorize().
+	*/
+	static QCPRange range(const WfColorMap& colorMap, const QtInterval& interval, bool* logarithmic);
+};
@@ -1,8 +1,82 @@
 #include "WfColorMap.h"
 
 #include "Interval.h"
+#include <qbytearray.h>
 #include <qvector.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//size of the precomputed lookup tables
+static const int LookupTableSize = 4096;
+
+//lookup tables of LinearColorMap shared by every map with the same configuration
+static const int LookupTableCacheSize = 64;
+
+static QHash<QByteArray, QVector<QRgb>>& lookupTableCache()
+{
+    static QHash<QByteArray, QVector<QRgb>> cache;
+    return cache;
+}
+
+static QMutex& lookupTableCacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+template <typename T>
+static inline void appendKey(QByteArray& key, const T& value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/*
+    Value transform and quantization to [0, levels - 1] in blocks,
+    store(i, index) receives the index of values[i].
+    The positions in the interval are computed and clipped to [0, 1] by the batch
+    kernels of QtInterval. NaN (log of a negative value) lands on the first index.
+*/
+template <typename Store>
+static inline void transformRow(WfColorMap::Transform transform, const QtInterval& interval,
+    const double* values, int count, int levels, Store store)
+{
+    static const QtInterval unit(0.0, 1.0);
+    const double maxIndex = levels - 1;
+
+    const int BlockSize = 256;
+    double block[BlockSize];
+
+    for (int first = 0; first < count; first += BlockSize)
+    {
+        const int n = qMin(BlockSize, count - first);
+        const double* source = values + first;
+
+        switch (transform)
+        {
+        case WfColorMap::Log10:
+            for (int i = 0; i < n; i++)
+                block[i] = std::log10(source[i]);
+            source = block;
+            break;
+        case WfColorMap::Decibel:
+            for (int i = 0; i < n; i++)
+                block[i] = 10.0 * std::log10(source[i]);
+            source = block;
+            break;
+        default:
+            break;
+        }
+
+        interval.normalize(source, block, n);
+        unit.clamp(block, block, n);
+
+        for (int i = 0; i < n; i++)
+            store(first + i, static_cast<int>(block[i] * maxIndex + 0.5));
+    }
+}
+
 
 class LinearColorMap::ColorStops
 {
@@ -15,9 +89,9 @@ public:
 
     void insert(double pos, const QColor& color);
     QRgb rgb(LinearColorMap::Mode, double pos) const;
-    double value(LinearColorMap::Mode, QRgb color, double width) const;
 
     QVector< double > stops() const;
+    void appendKey(QByteArray& key) const;
 
 private:
 
@@ -123,6 +197,15 @@ inline QVector< double > LinearColorMap::ColorStops::stops() const
     return positions;
 }
 
+void LinearColorMap::ColorStops::appendKey(QByteArray& key) const
+{
+    for (const ColorStop& stop : m_stops)
+    {
+        ::appendKey(key, stop.pos);
+        ::appendKey(key, stop.rgb);
+    }
+}
+
 inline int LinearColorMap::ColorStops::findUpper(double pos) const
 {
     int index = 0;
@@ -189,48 +272,237 @@ inline QRgb LinearColorMap::ColorStops::rgb(
     }
 }
 
-double LinearColorMap::ColorStops::value(LinearColorMap::Mode mode, QRgb color, double width) const
+
+WfColorMap::WfColorMap(Format format) : _format(format), _transform(Linear), _gamma(1.0), _premultiplied(false),
+    _reverseLookupReady(0)
 {
-    if (mode == FixedColors)
-    {
-        int index = 0;
-        bool find = false;
+}
 
-        for (auto it = m_stops.constBegin(); it != m_stops.constEnd(); it++, index++)
-        {
-            if (it->rgb == color)
-            {
-                find = true;
-                break;
-            }
-        }
-        if (!find) index = 0;
+WfColorMap::~WfColorMap()
+{
+}
+
+void WfColorMap::setFormat(Format format)
+{
+    _format = format;
+}
+
+WfColorMap::Format WfColorMap::format() const
+{
+    return _format;
+}
+
+void WfColorMap::setTransform(Transform transform, double gamma)
+{
+    if (gamma <= 0.0)
+        gamma = 1.0;
+
+    if (_transform == transform && _gamma == gamma)
+        return;
+
+    _transform = transform;
+    _gamma = gamma;
 
-        return index / static_cast<double>(m_stops.size());
+    updateLookupTable();
+}
+
+WfColorMap::Transform WfColorMap::transform() const
+{
+    return _transform;
+}
+
+double WfColorMap::gamma() const
+{
+    return _gamma;
+}
+
+void WfColorMap::setPremultiplied(bool premultiplied)
+{
+    if (_premultiplied == premultiplied)
+        return;
+
+    _premultiplied = premultiplied;
+
+    updateLookupTable();
+}
+
+bool WfColorMap::isPremultiplied() const
+{
+    return _premultiplied;
+}
+
+double WfColorMap::transformValue(double value) const
+{
+    switch (_transform)
+    {
+    case Log10:
+        return std::log10(value);
+    case Decibel:
+        return 10.0 * std::log10(value);
+    default:
+        return value;
     }
-    else
+}
+
+double WfColorMap::inverseTransformValue(double value) const
+{
+    switch (_transform)
     {
+    case Log10:
+        return std::pow(10.0, value);
+    case Decibel:
+        return std::pow(10.0, value / 10.0);
+    default:
+        return value;
+    }
+}
+
+double WfColorMap::shapeRatio(double ratio) const
+{
+    if (!(ratio > 0.0))
         return 0.0;
+    if (ratio >= 1.0)
+        return 1.0;
+
+    switch (_transform)
+    {
+    case Gamma:
+        return std::pow(ratio, _gamma);
+    case Sqrt:
+        return std::sqrt(ratio);
+    default:
+        return ratio;
     }
 }
 
+double WfColorMap::normalize(const QtInterval& interval, double value) const
+{
+    const double width = interval.width();
+    if (width <= 0.0)
+        return 0.0;
 
-WfColorMap::WfColorMap(Format format) : _format(format)
+    return shapeRatio((transformValue(value) - interval.minValue()) / width);
+}
+
+void WfColorMap::updateLookupTable()
 {
 }
 
-WfColorMap::~WfColorMap()
+/*
+    Fused transform and table lookup, the ratio shaping (gamma, sqrt)
+    has to be baked into the table by the caller.
+*/
+void WfColorMap::lookupRow(const QtInterval& interval, const double* values, QRgb* colors, int count,
+    const QRgb* lut, int lutSize) const
 {
+    const double width = interval.width();
+    if (width <= 0.0)
+    {
+        std::fill_n(colors, count, 0u);
+        return;
+    }
+
+    transformRow(_transform, interval, values, count, lutSize,
+        [=](int i, int index) { colors[i] = lut[index]; });
 }
 
-void WfColorMap::setFormat(Format format)
+void WfColorMap::indexRow(const QtInterval& interval, const double* values, quint16* indices, int count, int levels) const
 {
-    _format = format;
+    if (interval.width() <= 0.0)
+    {
+        std::fill_n(indices, count, quint16(0));
+        return;
+    }
+
+    transformRow(_transform, interval, values, count, levels,
+        [=](int i, int index) { indices[i] = static_cast<quint16>(index); });
 }
 
-WfColorMap::Format WfColorMap::format() const
+void WfColorMap::palette(QRgb* colors, int count) const
 {
-    return _format;
+    if (count <= 0)
+        return;
+
+    //positions are in the transformed unit, undo the transform before rgb() applies it again
+    const QtInterval unit(0.0, 1.0);
+    const double maxIndex = qMax(1, count - 1);
+    for (int i = 0; i < count; i++)
+        colors[i] = rgb(unit, inverseTransformValue(i / maxIndex));
+}
+
+void WfColorMap::resampleTable(const QRgb* lut, int lutSize, QRgb* colors, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (count == lutSize)
+    {
+        std::copy(lut, lut + lutSize, colors);
+        return;
+    }
+
+    const double scale = (lutSize - 1) / static_cast<double>(qMax(1, count - 1));
+    for (int i = 0; i < count; i++)
+        colors[i] = lut[static_cast<int>(i * scale + 0.5)];
+}
+
+const QRgb* WfColorMap::lookupTable(int* size) const
+{
+    if (size)
+        *size = 0;
+
+    return nullptr;
+}
+
+void WfColorMap::invalidateReverseLookup()
+{
+    _reverseLookupReady.storeRelease(0);
+}
+
+double WfColorMap::reverseLookup(QRgb color) const
+{
+    if (!_reverseLookupReady.loadAcquire())
+    {
+        QMutexLocker locker(&_reverseLookupMutex);
+        if (!_reverseLookupReady.loadAcquire())
+        {
+            buildReverseLookup();
+            _reverseLookupReady.storeRelease(1);
+        }
+    }
+
+    const auto it = _reverseLookup.constFind(color);
+    if (it == _reverseLookup.constEnd())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return it.value();
+}
+
+void WfColorMap::buildReverseLookup() const
+{
+    int lutSize = 0;
+    const QRgb* lut = lookupTable(&lutSize);
+
+    _reverseLookup.clear();
+    if (lut == nullptr || lutSize <= 1)
+        return;
+
+    _reverseLookup.reserve(lutSize);
+
+    const double maxIndex = lutSize - 1;
+
+    int runStart = 0;
+    for (int i = 1; i <= lutSize; i++)
+    {
+        if (i < lutSize && lut[i] == lut[runStart])
+            continue;
+
+        //a color repeated later in the table keeps its first run
+        if (!_reverseLookup.contains(lut[runStart]))
+            _reverseLookup.insert(lut[runStart], (runStart + i - 1) / 2.0 / maxIndex);
+
+        runStart = i;
+    }
 }
 
 uint WfColorMap::colorIndex(int numColors, const QtInterval& interval, double value) const
@@ -239,17 +511,17 @@ uint WfColorMap::colorIndex(int numColors, const QtInterval& interval, double va
     if (width <= 0.0)
         return 0;
 
-    if (value <= interval.minValue())
-        return 0;
-
     const int maxIndex = numColors - 1;
-    if (value >= interval.maxValue())
-        return maxIndex;
-
-    const double v = maxIndex * ((value - interval.minValue()) / width);
+    const double v = maxIndex * normalize(interval, value);
     return static_cast<unsigned int>(v + 0.5);
 }
 
+void WfColorMap::rgbRow(const QtInterval& interval, const double* values, QRgb* colors, int count) const
+{
+    for (int i = 0; i < count; i++)
+        colors[i] = rgb(interval, values[i]);
+}
+
 QVector<QRgb> WfColorMap::colorTable(int numColors) const
 {
     QVector<QRgb> table(256);
@@ -279,6 +551,11 @@ class LinearColorMap::PrivateData
 public:
     ColorStops colorStops;
     LinearColorMap::Mode mode;
+
+    //colors of the stops sampled over the shaped ratio, used by rgbRow, built on first use
+    QVector<QRgb> lookupTable;
+    QAtomicInt lookupTableReady;
+    QMutex lookupTableMutex;
 };
 
 
@@ -307,6 +584,7 @@ LinearColorMap::~LinearColorMap()
 void LinearColorMap::setMode(Mode mode)
 {
     m_data->mode = mode;
+    updateLookupTable();
 }
 
 LinearColorMap::Mode LinearColorMap::mode() const
@@ -319,12 +597,16 @@ void LinearColorMap::setColorInterval(const QColor& color1, const QColor& color2
     m_data->colorStops = ColorStops();
     m_data->colorStops.insert(0.0, color1);
     m_data->colorStops.insert(1.0, color2);
+    updateLookupTable();
 }
 
 void LinearColorMap::addColorStop(double value, const QColor& color)
 {
     if (value >= 0.0 && value <= 1.0)
+    {
         m_data->colorStops.insert(value, color);
+        updateLookupTable();
+    }
 }
 
 QVector<double> LinearColorMap::colorStops() const
@@ -348,17 +630,103 @@ QRgb LinearColorMap::rgb(const QtInterval& interval, double value) const
     if (width <= 0.0)
         return 0u;
 
-    const double ratio = (value - interval.minValue()) / width;
-    return m_data->colorStops.rgb(m_data->mode, ratio);
+    const double ratio = shapeRatio((transformValue(value) - interval.minValue()) / width);
+    const QRgb color = m_data->colorStops.rgb(m_data->mode, ratio);
+
+    return isPremultiplied() ? qPremultiply(color) : color;
 }
 
-double LinearColorMap::RGB2Double(const QtInterval& interval, QRgb color)
+void LinearColorMap::rgbRow(const QtInterval& interval, const double* values, QRgb* colors, int count) const
 {
-    const double width = interval.width();
-    if (width <= 0.0)
-        return 0.0;
-    
-    return m_data->colorStops.value(m_data->mode, color, width);
+    int size = 0;
+    const QRgb* lut = lookupTable(&size);
+    lookupRow(interval, values, colors, count, lut, size);
+}
+
+void LinearColorMap::palette(QRgb* colors, int count) const
+{
+    int size = 0;
+    const QRgb* lut = lookupTable(&size);
+    resampleTable(lut, size, colors, count);
+}
+
+void LinearColorMap::updateLookupTable()
+{
+    m_data->lookupTableReady.storeRelease(0);
+    invalidateReverseLookup();
+}
+
+const QRgb* LinearColorMap::lookupTable(int* size) const
+{
+    if (!m_data->lookupTableReady.loadAcquire())
+    {
+        QMutexLocker locker(&m_data->lookupTableMutex);
+        if (!m_data->lookupTableReady.loadAcquire())
+        {
+            buildLookupTable();
+            m_data->lookupTableReady.storeRelease(1);
+        }
+    }
+
+    if (size)
+        *size = m_data->lookupTable.size();
+
+    return m_data->lookupTable.constData();
+}
+
+void LinearColorMap::buildLookupTable() const
+{
+    QByteArray key;
+    m_data->colorStops.appendKey(key);
+    appendKey(key, m_data->mode);
+    appendKey(key, transform());
+    appendKey(key, gamma());
+    appendKey(key, isPremultiplied());
+
+    {
+        QMutexLocker locker(&lookupTableCacheMutex());
+
+        const auto it = lookupTableCache().constFind(key);
+        if (it != lookupTableCache().constEnd())
+        {
+            //implicitly shared, every map with this configuration uses the same table
+            m_data->lookupTable = it.value();
+            return;
+        }
+    }
+
+    QVector<QRgb> table(LookupTableSize);
+
+    const double maxIndex = LookupTableSize - 1;
+    for (int i = 0; i < LookupTableSize; i++)
+    {
+        table[i] = m_data->colorStops.rgb(m_data->mode, shapeRatio(i / maxIndex));
+    }
+
+    if (isPremultiplied())
+    {
+        for (int i = 0; i < LookupTableSize; i++)
+            table[i] = qPremultiply(table[i]);
+    }
+
+    {
+        QMutexLocker locker(&lookupTableCacheMutex());
+
+        if (lookupTableCache().size() >= LookupTableCacheSize)
+            lookupTableCache().clear();
+
+        lookupTableCache().insert(key, table);
+    }
+
+    m_data->lookupTable = table;
+}
+
+double LinearColorMap::RGB2Double(const QtInterval& interval, QRgb color) const
+{
+    if (interval.width() <= 0.0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return reverseLookup(color);
 }
 
 uint LinearColorMap::colorIndex(int numColors, const QtInterval& interval, double value) const
@@ -367,12 +735,6 @@ uint LinearColorMap::colorIndex(int numColors, const QtInterval& interval, doubl
     if (width <= 0.0)
         return 0;
 
-    if (value <= interval.minValue())
-        return 0;
-
-    if (value >= interval.maxValue())
-        return numColors - 1;
-
-    const double v = (numColors - 1) * (value - interval.minValue()) / width;
+    const double v = (numColors - 1) * normalize(interval, value);
     return static_cast<unsigned int>((m_data->mode == FixedColors) ? v : v + 0.5);
 }
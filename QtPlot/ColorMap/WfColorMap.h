@@ -1,7 +1,11 @@
 #pragma once
 
 #include "QtPlotGlobal.h"
+#include <qatomic.h>
 #include <qcolor.h>
+#include <qhash.h>
+#include <qmutex.h>
+#include <qsharedpointer.h>
 
 
 class QtInterval;
@@ -10,6 +14,12 @@ class QtInterval;
 template< typename T > class QVector;
 #endif
 
+/*!
+\brief Base class of the value to color maps
+
+Maps are configured with the non-const setters and then shared as WfColorMapPtr,
+every const method is thread-safe. Lookup tables are built on first use.
+*/
 class QTPLOT_EXPORT WfColorMap
 {
 public:
@@ -19,26 +29,128 @@ public:
 		Indexed
 	};
 
+	/*!
+	\brief Transformation applied to the values before the color lookup
+
+	Log10 and Decibel transform the value itself (10 * log10 for Decibel),
+	the interval is then given in the transformed unit.
+	Gamma and Sqrt reshape the normalized ratio, the interval keeps the value unit.
+	*/
+	enum Transform
+	{
+		Linear,
+		Log10,
+		Decibel,
+		Gamma,
+		Sqrt
+	};
+
 	explicit WfColorMap(Format = RGB);
 	virtual ~WfColorMap();
 
 	void setFormat(Format);
 	Format format() const;
 
+	void setTransform(Transform transform, double gamma = 1.0);
+	Transform transform() const;
+	double gamma() const;
+
+	/*!
+	\brief Emit premultiplied colors (for QImage::Format_ARGB32_Premultiplied targets)
+	*/
+	void setPremultiplied(bool premultiplied);
+	bool isPremultiplied() const;
+
+	double transformValue(double value) const;
+	double inverseTransformValue(double value) const;
+	double shapeRatio(double ratio) const;
+	double normalize(const QtInterval& interval, double value) const;
+
 	virtual QRgb rgb(const QtInterval& interval, double value) const = 0;
-    virtual double RGB2Double(const QtInterval& interval, QRgb color) = 0;
+
+	/*!
+	\brief Inverse of rgb()
+
+	\return Position of the color inside the interval (0..1, in the transformed unit),
+	NaN if the color is not produced by the color map.
+	*/
+    virtual double RGB2Double(const QtInterval& interval, QRgb color) const = 0;
 	virtual uint colorIndex(int numColors, const QtInterval& interval, double value) const;
 
+	/*!
+	\brief Colorize a row of values, batch version of rgb()
+
+	\param interval Range of the values.
+	\param values Array of double values. Size: count.
+	\param colors Output colors. Size: count.
+	\param count Number of values.
+	*/
+	virtual void rgbRow(const QtInterval& interval, const double* values, QRgb* colors, int count) const;
+
+	/*!
+	\brief Quantize a row of values to color indexes
+
+	Index i of 'levels' is the color of palette(colors, levels)[i].
+
+	\param interval Range of the values.
+	\param values Array of double values. Size: count.
+	\param indices Output indexes in [0, levels - 1]. Size: count.
+	\param count Number of values.
+	\param levels Number of quantization levels.
+	*/
+	void indexRow(const QtInterval& interval, const double* values, quint16* indices, int count, int levels) const;
+
+	/*!
+	\brief Colors of 'count' evenly spaced positions of the interval, transform and output format applied
+	*/
+	virtual void palette(QRgb* colors, int count) const;
+
 	QColor color(const QtInterval&, double value) const;
 	virtual QVector<QRgb> colorTable(int numColors) const;
 	virtual QVector<QRgb> colorTable256() const;
 
+protected:
+	/*!
+	\brief Rebuild the precomputed tables, called when the transform or the output format changes
+	*/
+	virtual void updateLookupTable();
+
+	void lookupRow(const QtInterval& interval, const double* values, QRgb* colors, int count,
+		const QRgb* lut, int lutSize) const;
+
+	static void resampleTable(const QRgb* lut, int lutSize, QRgb* colors, int count);
+
+	/*!
+	\brief Lookup table of the map, inverted by reverseLookup(). Null when the map has none.
+	*/
+	virtual const QRgb* lookupTable(int* size) const;
+
+	/*!
+	\brief Color to position lookup
+
+	The hash is built from lookupTable() on the first call,
+	runs of equal colors map to the middle of the run.
+	*/
+	double reverseLookup(QRgb color) const;
+	void invalidateReverseLookup();
+
 private:
+	void buildReverseLookup() const;
+
 	Q_DISABLE_COPY(WfColorMap)
 	Format _format;
+	Transform _transform;
+	double _gamma;
+	bool _premultiplied;
+
+	mutable QMutex _reverseLookupMutex;
+	mutable QAtomicInt _reverseLookupReady;
+	mutable QHash<QRgb, double> _reverseLookup;
 
 };
 
+typedef QSharedPointer<const WfColorMap> WfColorMapPtr;
+
 class QTPLOT_EXPORT LinearColorMap : public WfColorMap
 {
 public:
@@ -72,14 +184,25 @@ public:
         double value) const override;
 
     virtual double RGB2Double(const QtInterval& interval,
-        QRgb color) override;
+        QRgb color) const override;
 
     virtual uint colorIndex(int numColors,
         const QtInterval&, double value) const override;
 
+    virtual void rgbRow(const QtInterval& interval,
+        const double* values, QRgb* colors, int count) const override;
+
+    virtual void palette(QRgb* colors, int count) const override;
+
     class ColorStops;
 
+protected:
+    virtual void updateLookupTable() override;
+    virtual const QRgb* lookupTable(int* size) const override;
+
 private:
+    void buildLookupTable() const;
+
     class PrivateData;
     PrivateData* m_data;
 };
\ No newline at end of file
@@ -9,6 +9,14 @@
 
 #include "Interval.h"
 
+#include <qalgorithms.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define QT_INTERVAL_SSE2
+# include <emmintrin.h>
+#endif
+
 namespace
 {
     static const struct RegisterQwtInterval
@@ -16,6 +24,36 @@ namespace
         inline RegisterQwtInterval() { qRegisterMetaType<QtInterval>(); }
 
     } qwtRegisterQwtInterval;
+
+    template< typename T >
+    inline bool isInside( T value, T minValue, T maxValue,
+        bool excludeMinimum, bool excludeMaximum )
+    {
+        const bool aboveMinimum = excludeMinimum ? value > minValue : value >= minValue;
+        const bool belowMaximum = excludeMaximum ? value < maxValue : value <= maxValue;
+
+        return aboveMinimum && belowMaximum;
+    }
+
+    template< typename T >
+    inline void normalizeScalar( const T* values, T* result, int from, int count,
+        T scale, T offset )
+    {
+        for ( int i = from; i < count; i++ )
+            result[i] = values[i] * scale + offset;
+    }
+
+    // NaN fails both comparisons and ends up at the minimum, like the SSE2 min/max
+    template< typename T >
+    inline void clampScalar( const T* values, T* result, int from, int count,
+        T minValue, T maxValue )
+    {
+        for ( int i = from; i < count; i++ )
+        {
+            const T value = values[i] > minValue ? values[i] : minValue;
+            result[i] = value < maxValue ? value : maxValue;
+        }
+    }
 }
 
 /*!
@@ -119,6 +157,264 @@ bool QtInterval::contains( const QtInterval& interval ) const
     return true;
 }
 
+/*!
+   \brief Map values to their position in the interval
+
+   result[i] = ( values[i] - minValue() ) / width(), computed with the reciprocal
+   of the width. Values outside of the interval are not clipped,
+   an interval without width gives 0.0.
+
+   \param values Input values
+   \param result Output positions, may be values
+   \param count Number of values
+ */
+void QtInterval::normalize( const double* values, double* result, int count ) const
+{
+    const double w = width();
+    if ( w <= 0.0 )
+    {
+        std::fill_n( result, count, 0.0 );
+        return;
+    }
+
+    const double scale = 1.0 / w;
+    const double offset = -m_minValue * scale;
+
+    int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128d s = _mm_set1_pd( scale );
+    const __m128d o = _mm_set1_pd( offset );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m128d v0 = _mm_loadu_pd( values + i );
+        const __m128d v1 = _mm_loadu_pd( values + i + 2 );
+
+        _mm_storeu_pd( result + i, _mm_add_pd( _mm_mul_pd( v0, s ), o ) );
+        _mm_storeu_pd( result + i + 2, _mm_add_pd( _mm_mul_pd( v1, s ), o ) );
+    }
+#endif
+
+    normalizeScalar( values, result, i, count, scale, offset );
+}
+
+//! \copydoc normalize(const double*, double*, int) const
+void QtInterval::normalize( const float* values, float* result, int count ) const
+{
+    const double w = width();
+    if ( w <= 0.0 )
+    {
+        std::fill_n( result, count, 0.0f );
+        return;
+    }
+
+    const float scale = static_cast< float >( 1.0 / w );
+    const float offset = static_cast< float >( -m_minValue / w );
+
+    int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128 s = _mm_set1_ps( scale );
+    const __m128 o = _mm_set1_ps( offset );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m128 v = _mm_loadu_ps( values + i );
+        _mm_storeu_ps( result + i, _mm_add_ps( _mm_mul_ps( v, s ), o ) );
+    }
+#endif
+
+    normalizeScalar( values, result, i, count, scale, offset );
+}
+
+/*!
+   \brief Clip values to the limits of the interval
+
+   NaN is mapped to minValue(). The values are copied unchanged for an invalid interval.
+
+   \param values Input values
+   \param result Output values, may be values
+   \param count Number of values
+ */
+void QtInterval::clamp( const double* values, double* result, int count ) const
+{
+    if ( !isValid() )
+    {
+        if ( result != values )
+            std::copy( values, values + count, result );
+        return;
+    }
+
+    int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128d lower = _mm_set1_pd( m_minValue );
+    const __m128d upper = _mm_set1_pd( m_maxValue );
+
+    for ( ; i + 2 <= count; i += 2 )
+    {
+        // _mm_max_pd returns the second operand when the first one is NaN
+        const __m128d v = _mm_max_pd( _mm_loadu_pd( values + i ), lower );
+        _mm_storeu_pd( result + i, _mm_min_pd( v, upper ) );
+    }
+#endif
+
+    clampScalar( values, result, i, count, m_minValue, m_maxValue );
+}
+
+//! \copydoc clamp(const double*, double*, int) const
+void QtInterval::clamp( const float* values, float* result, int count ) const
+{
+    if ( !isValid() )
+    {
+        if ( result != values )
+            std::copy( values, values + count, result );
+        return;
+    }
+
+    const float minValue = static_cast< float >( m_minValue );
+    const float maxValue = static_cast< float >( m_maxValue );
+
+    int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128 lower = _mm_set1_ps( minValue );
+    const __m128 upper = _mm_set1_ps( maxValue );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m128 v = _mm_max_ps( _mm_loadu_ps( values + i ), lower );
+        _mm_storeu_ps( result + i, _mm_min_ps( v, upper ) );
+    }
+#endif
+
+    clampScalar( values, result, i, count, minValue, maxValue );
+}
+
+/*!
+   \brief Test an array of values, border flags are respected
+
+   NaN values are outside.
+
+   \param values Input values
+   \param count Number of values
+   \param mask Optional bit mask, bit ( i % 32 ) of mask[i / 32] is set
+                when values[i] is inside. Size: ( count + 31 ) / 32.
+   \return Number of values inside the interval
+ */
+int QtInterval::contains( const double* values, int count, quint32* mask ) const
+{
+    const int words = ( count + 31 ) / 32;
+
+    if ( !isValid() )
+    {
+        if ( mask )
+            std::fill_n( mask, words, 0u );
+        return 0;
+    }
+
+    const bool excludeMinimum = m_borderFlags & ExcludeMinimum;
+    const bool excludeMaximum = m_borderFlags & ExcludeMaximum;
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128d lower = _mm_set1_pd( m_minValue );
+    const __m128d upper = _mm_set1_pd( m_maxValue );
+#endif
+
+    int inside = 0;
+    for ( int word = 0; word < words; word++ )
+    {
+        const double* block = values + word * 32;
+        const int n = qMin( 32, count - word * 32 );
+
+        quint32 bits = 0;
+        int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+        for ( ; i + 2 <= n; i += 2 )
+        {
+            const __m128d v = _mm_loadu_pd( block + i );
+            const __m128d aboveMinimum = excludeMinimum ? _mm_cmpgt_pd( v, lower ) : _mm_cmpge_pd( v, lower );
+            const __m128d belowMaximum = excludeMaximum ? _mm_cmplt_pd( v, upper ) : _mm_cmple_pd( v, upper );
+
+            bits |= static_cast< quint32 >( _mm_movemask_pd( _mm_and_pd( aboveMinimum, belowMaximum ) ) ) << i;
+        }
+#endif
+
+        for ( ; i < n; i++ )
+        {
+            if ( isInside( block[i], m_minValue, m_maxValue, excludeMinimum, excludeMaximum ) )
+                bits |= 1u << i;
+        }
+
+        if ( mask )
+            mask[word] = bits;
+
+        inside += qPopulationCount( bits );
+    }
+
+    return inside;
+}
+
+//! \copydoc contains(const double*, int, quint32*) const
+int QtInterval::contains( const float* values, int count, quint32* mask ) const
+{
+    const int words = ( count + 31 ) / 32;
+
+    if ( !isValid() )
+    {
+        if ( mask )
+            std::fill_n( mask, words, 0u );
+        return 0;
+    }
+
+    const bool excludeMinimum = m_borderFlags & ExcludeMinimum;
+    const bool excludeMaximum = m_borderFlags & ExcludeMaximum;
+
+    const float minValue = static_cast< float >( m_minValue );
+    const float maxValue = static_cast< float >( m_maxValue );
+
+#ifdef QT_INTERVAL_SSE2
+    const __m128 lower = _mm_set1_ps( minValue );
+    const __m128 upper = _mm_set1_ps( maxValue );
+#endif
+
+    int inside = 0;
+    for ( int word = 0; word < words; word++ )
+    {
+        const float* block = values + word * 32;
+        const int n = qMin( 32, count - word * 32 );
+
+        quint32 bits = 0;
+        int i = 0;
+
+#ifdef QT_INTERVAL_SSE2
+        for ( ; i + 4 <= n; i += 4 )
+        {
+            const __m128 v = _mm_loadu_ps( block + i );
+            const __m128 aboveMinimum = excludeMinimum ? _mm_cmpgt_ps( v, lower ) : _mm_cmpge_ps( v, lower );
+            const __m128 belowMaximum = excludeMaximum ? _mm_cmplt_ps( v, upper ) : _mm_cmple_ps( v, upper );
+
+            bits |= static_cast< quint32 >( _mm_movemask_ps( _mm_and_ps( aboveMinimum, belowMaximum ) ) ) << i;
+        }
+#endif
+
+        for ( ; i < n; i++ )
+        {
+            if ( isInside( block[i], minValue, maxValue, excludeMinimum, excludeMaximum ) )
+                bits |= 1u << i;
+        }
+
+        if ( mask )
+            mask[word] = bits;
+
+        inside += qPopulationCount( bits );
+    }
+
+    return inside;
+}
+
 //! Unite 2 intervals
 QtInterval QtInterval::unite( const QtInterval& other ) const
 {
@@ -73,6 +73,19 @@ class QTPLOT_EXPORT QtInterval
     bool contains( double value ) const;
     bool contains( const QtInterval& ) const;
 
+    /*
+       Batch operations over arrays, SSE2 when available.
+       result may alias values.
+     */
+    void normalize( const double* values, double* result, int count ) const;
+    void normalize( const float* values, float* result, int count ) const;
+
+    void clamp( const double* values, double* result, int count ) const;
+    void clamp( const float* values, float* result, int count ) const;
+
+    int contains( const double* values, int count, quint32* mask = nullptr ) const;
+    int contains( const float* values, int count, quint32* mask = nullptr ) const;
+
     bool intersects( const QtInterval& ) const;
     QtInterval intersect( const QtInterval& ) const;
     QtInterval unite( const QtInterval& ) const;
@@ -34,9 +34,50 @@ enum EShowInfoRule
 	ESIR_Attach,
 };
 
+enum EInfoSnap
+{
+	EIS_Key,
+	EIS_Nearest
+};
+
 enum EClickPos
 {
 	ECA_ClickX,
 	ECA_ClickY,
 	ECA_ClickPlot,
+};
+
+enum EWaterfallStage
+{
+	EWS_Copy,
+	EWS_QueueWait,
+	EWS_Colorize,
+	EWS_UpdatePixmap,
+	EWS_ScaledPixmap,
+	EWS_Draw,
+
+	EWS_Count
+};
+
+enum EWaterfallTrace
+{
+	EWT_Raw,
+	EWT_MaxHold,
+	EWT_Average,
+	EWT_MinHold
+};
+
+enum EResampleMode
+{
+	ERM_Max,
+	ERM_Mean,
+	ERM_Min,
+	ERM_Decimate
+};
+
+enum EExportFormat
+{
+	EEF_Png,
+	EEF_RawFloat,
+	EEF_Npy
 };
\ No newline at end of file
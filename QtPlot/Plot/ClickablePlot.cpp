@@ -246,8 +246,9 @@ QCPRange ClickablePlot::resetByGraphX()
 
     if (!mainGraph || mainGraph->dataCount() == 0) return defaultZoomMap[EA_xAxis];
 
-    const double min = mainGraph->data()->at(0)->key;
-    const double max = mainGraph->data()->at(mainGraph->data()->size())->key;
+    //first and last key through the 1D interface, computed for uniform keys
+    const double min = mainGraph->dataMainKey(0);
+    const double max = mainGraph->dataMainKey(mainGraph->dataCount() - 1);
 
     return { min, max };
 }
@@ -258,23 +259,15 @@ QCPRange ClickablePlot::resetByGraphY()
 
     if (!mainGraph || mainGraph->dataCount() == 0) return defaultZoomMap[EA_yAxis];
 
-    double min = mainGraph->data()->at(0)->value;
-    double max = min;
+    //graphs with a data source (uniform keys) keep no points in data()
+    bool foundRange = false;
+    const QCPRange valueRange = mainGraph->getValueRange(foundRange);
+    if (!foundRange) return defaultZoomMap[EA_yAxis];
 
-    for (auto it = mainGraph->data()->begin(); it != mainGraph->data()->end(); it++)
-    {
-        if (it->value > max)
-        {
-            max = it->value;
-        }
-
-        if (it->value < min)
-        {
-            min = it->value;
-        }
-    }
+    const double min = valueRange.lower;
+    const double max = valueRange.upper;
 
-    double delta = (max - max) * 0.2;
+    double delta = (max - min) * 0.2;
 
     if (equals(delta, 0.0))
     {
@@ -56,7 +56,17 @@ QString InfoPlot::createTooltipText(double x, double y)
     return QString::number(x) + " | " + QString::number(y);
 }
 
-QString InfoPlot::updateTooltip(double x, double y)
+void InfoPlot::setInfoSnap(EInfoSnap snap)
+{
+    infoSnap = snap;
+}
+
+void InfoPlot::setSnapTolerance(int pixels)
+{
+    snapTolerance = qMax(0, pixels);
+}
+
+QString InfoPlot::updateTooltip(const QPoint& pos, double x, double y)
 {
     if(showInfoRule == ESIR_None)
     {
@@ -65,28 +75,91 @@ QString InfoPlot::updateTooltip(double x, double y)
 
 	if(showInfoRule == ESIR_Attach)
     {
-        if (infoGraphIndex < 0 && infoGraphIndex > graphCount()) return "";
-        if (graph(infoGraphIndex) == nullptr || graph(infoGraphIndex)->data().isNull()) return "";
+        if (infoGraphIndex < 0 || infoGraphIndex >= graphCount()) return "";
+
+        const QCPGraph* infoGraph = graph(infoGraphIndex);
+        if (infoGraph == nullptr || infoGraph->dataCount() == 0 || infoGraph->keyAxis() == nullptr) return "";
+
+        const int index = infoSnap == EIS_Nearest ? findNearestPoint(infoGraph, pos) : findNearestKey(infoGraph, pos);
+        if (index < 0) return "";
+
+        return attachInfoMarker(infoGraph->dataMainKey(index), infoGraph->dataMainValue(index));
+    }
 
-        const int size = graph(infoGraphIndex)->data()->size();
+    return "";
+}
+
+int InfoPlot::findNearestKey(const QCPGraph* infoGraph, const QPoint& pos) const
+{
+    const QCPAxis* keyAxis = infoGraph->keyAxis();
+    const double keyPixel = keyAxis->orientation() == Qt::Horizontal ? pos.x() : pos.y();
+
+    //sorted keys: binary search (computed for uniform keys), the nearest is the found point or the one before
+    int index = infoGraph->findBegin(keyAxis->pixelToCoord(keyPixel), false);
+    if (index == infoGraph->dataCount())
+    {
+        index--;
+    }
 
-        for(int index = 0; index < size; index++)
+    double distance = fabs(keyAxis->coordToPixel(infoGraph->dataMainKey(index)) - keyPixel);
+    if (index > 0)
+    {
+        const double previousDistance = fabs(keyAxis->coordToPixel(infoGraph->dataMainKey(index - 1)) - keyPixel);
+        if (previousDistance < distance)
         {
-	        const auto point = graph(infoGraphIndex)->data()->at(index);
-			if(fabs(point->key - x) < 0.5)
-            {
-                {
-                    graphMarker->clearData();
-                    graphMarker->addData(point->key, point->value);
-                    layer(MARKERS_LAYER_NAME)->replot();
-                }
-
-                return createTooltipText(point->key, point->value);
-            }
+            index--;
+            distance = previousDistance;
         }
     }
 
-    return "";
+    return distance <= snapTolerance ? index : -1;
+}
+
+int InfoPlot::findNearestPoint(const QCPGraph* infoGraph, const QPoint& pos) const
+{
+    const QCPAxis* keyAxis = infoGraph->keyAxis();
+    const double keyPixel = keyAxis->orientation() == Qt::Horizontal ? pos.x() : pos.y();
+
+    //only points within the tolerance on the key axis can be within the radius
+    double lower = keyAxis->pixelToCoord(keyPixel - snapTolerance);
+    double upper = keyAxis->pixelToCoord(keyPixel + snapTolerance);
+    if (lower > upper)
+    {
+        qSwap(lower, upper);
+    }
+
+    const int end = infoGraph->findEnd(upper, false);
+
+    int nearest = -1;
+    double nearestDistance = snapTolerance * snapTolerance;
+    for (int index = infoGraph->findBegin(lower, false); index < end; index++)
+    {
+        const QPointF delta = infoGraph->dataPixelPosition(index) - pos;
+        const double distance = delta.x() * delta.x() + delta.y() * delta.y();
+        if (distance <= nearestDistance)
+        {
+            nearest = index;
+            nearestDistance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+QString InfoPlot::attachInfoMarker(double key, double value)
+{
+    //replot only when the snapped point changes
+    const bool unchanged = graphMarker->dataCount() == 1 && graphMarker->dataMainKey(0) == key
+        && (graphMarker->dataMainValue(0) == value || (qIsNaN(value) && qIsNaN(graphMarker->dataMainValue(0))));
+
+    if (!unchanged)
+    {
+        graphMarker->clearData();
+        graphMarker->addData(key, value);
+        getInteractionScheduler()->replotLayer(MARKERS_LAYER_NAME);
+    }
+
+    return createTooltipText(key, value);
 }
 
 void InfoPlot::mouseMovePlot(QMouseEvent* event)
@@ -96,7 +169,7 @@ void InfoPlot::mouseMovePlot(QMouseEvent* event)
 
     QToolTip::showText(
         event->globalPos(),
-        updateTooltip(x, y),
+        updateTooltip(event->pos(), x, y),
         this);
 }
 
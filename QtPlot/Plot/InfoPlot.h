@@ -18,11 +18,17 @@ public:
 	void setMarkerScatterStyle(QCPScatterStyle style) const;
 	void setShowInfoRule(EShowInfoRule rule);
 	void setInfoGraphIndex(int index);
+	void setInfoSnap(EInfoSnap snap);
+	void setSnapTolerance(int pixels);
 
 	virtual QString createTooltipText(double x, double y);
 
 private:
-	QString updateTooltip(double x, double y);
+	QString updateTooltip(const QPoint& pos, double x, double y);
+	QString attachInfoMarker(double key, double value);
+
+	int findNearestKey(const QCPGraph* infoGraph, const QPoint& pos) const;
+	int findNearestPoint(const QCPGraph* infoGraph, const QPoint& pos) const;
 
 private slots:
 	void mouseMovePlot(QMouseEvent* event);
@@ -30,6 +36,8 @@ private slots:
 private:
 	EShowInfoRule	showInfoRule = ESIR_None;
 	int				infoGraphIndex = 1;
+	EInfoSnap		infoSnap = EIS_Key;
+	int				snapTolerance = 10;
 
 	QCPGraph*		graphMarker;
 
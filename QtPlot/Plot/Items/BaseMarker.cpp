@@ -33,6 +33,13 @@ void BaseMarker::setPen(ELineState inState, QPen pen)
 
 void BaseMarker::replot()
 {
+	if (markingPlot)
+	{
+		//deferred to the end of the coalesced mouse move
+		markingPlot->getInteractionScheduler()->replotLayer(MARKERS_LAYER_NAME);
+		return;
+	}
+
 	parentPlot()->layer(MARKERS_LAYER_NAME)->replot();
 }
 
@@ -158,13 +158,13 @@ bool MovableInfinityLine::mouseMove(QMouseEvent* event)
 	
 	midLine->updatePosition();
 	emit updatePosition();
-	mParentPlot->layer(MARKERS_LAYER_NAME)->replot();
+	replot();
 
 	for(const auto& syncLine: syncLines)
 	{
 		syncLine->midLine->updatePosition();
 		emit syncLine->updatePosition();
-		syncLine->mParentPlot->layer(MARKERS_LAYER_NAME)->replot();
+		syncLine->replot();
 	}
 
 	return true;
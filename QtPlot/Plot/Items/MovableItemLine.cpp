@@ -1,6 +1,7 @@
 #include "MovableItemLine.h"
 
 #include "Plot/Items/MovableInfinityLine.h"
+#include "Plot/MarkingPlot.h"
 
 
 MovableItemLine::MovableItemLine(QCustomPlot* parentPlot, MovableInfinityLine* fMarker, MovableInfinityLine* sMarker, QCPItemText* text /*= nullptr*/)
@@ -10,6 +11,8 @@ MovableItemLine::MovableItemLine(QCustomPlot* parentPlot, MovableInfinityLine* f
 {
 	setLayer(MARKERS_LAYER_NAME);
 
+	markingPlot = dynamic_cast<MarkingPlot*>(parentPlot);
+
 	//initialize default pens
 	{
 		QPen pen;
@@ -186,11 +189,22 @@ void MovableItemLine::setState(ELineState inState)
 	if (needReplot) 
 	{
 		QCPItemLine::setPen(newPen);
-		mParentPlot->layer(MARKERS_LAYER_NAME)->replot();
-		// mParentPlot->replot();
+		replot();
 	}
 }
 
+void MovableItemLine::replot()
+{
+	if (markingPlot)
+	{
+		//deferred to the end of the coalesced mouse move
+		markingPlot->getInteractionScheduler()->replotLayer(MARKERS_LAYER_NAME);
+		return;
+	}
+
+	mParentPlot->layer(MARKERS_LAYER_NAME)->replot();
+}
+
 void MovableItemLine::xUpdate()
 {
 	QPointF leftMarker = firstMarker->getRealCoords();
@@ -267,5 +281,5 @@ void MovableItemLine::mouseMove(QMouseEvent* event)
 		yMoveAxis(event);
 	}
 
-	mParentPlot->layer(MARKERS_LAYER_NAME)->replot();
+	replot();
 }
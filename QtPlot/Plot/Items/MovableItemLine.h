@@ -5,6 +5,7 @@
 
 
 class MovableInfinityLine;
+class MarkingPlot;
 
 
 class MovableItemLine : public QCPItemLine
@@ -29,6 +30,7 @@ private:
 	void yMoveAxis(QMouseEvent* event);
 	void checkHovered(QMouseEvent* event);
 	void setState(ELineState state);
+	void replot();
 
 	void xUpdate();
 	void yUpdate();
@@ -46,6 +48,7 @@ private:
 	QMap<ELineState, QPen> pens;
 	EAxis axis;
 	bool bIsDrag = false;
+	MarkingPlot* markingPlot = nullptr;
 
 };
 
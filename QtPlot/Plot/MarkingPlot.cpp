@@ -10,6 +10,13 @@ MarkingPlot::MarkingPlot(QWidget* parent) : ZoomClampedPlot(parent)
 	markerActiveRules.insert(EA_xAxis, false);
 	markerActiveRules.insert(EA_yAxis, false);
 
+	//mouse moves reach QCustomPlot, the markers and the tooltip once per frame
+	interactionScheduler = new PlotInteractionScheduler(this);
+	connect(interactionScheduler, &PlotInteractionScheduler::mouseMoveReady, this, [this](QMouseEvent* event)
+	{
+		ZoomClampedPlot::mouseMoveEvent(event);
+	});
+
 	addLayer(MARKERS_LAYER_NAME);
 	QCPLayer* markerLayer = layer(MARKERS_LAYER_NAME);
 	markerLayer->setMode(QCPLayer::lmBuffered);
@@ -232,13 +239,26 @@ void MarkingPlot::forceUpdateHorizontalText()
 
 void MarkingPlot::mousePressEvent(QMouseEvent* event)
 {
+	interactionScheduler->flush();
 	QCustomPlot::mousePressEvent(event);
 
 	mouseClickPoint = event->pos();
 }
 
+void MarkingPlot::mouseMoveEvent(QMouseEvent* event)
+{
+	if (interactionScheduler->isEnabled() == false)
+	{
+		ZoomClampedPlot::mouseMoveEvent(event);
+		return;
+	}
+
+	interactionScheduler->postMouseMove(event);
+}
+
 void MarkingPlot::mouseReleaseEvent(QMouseEvent* event)
 {
+	interactionScheduler->flush();
 	QCustomPlot::mouseReleaseEvent(event);
 	
 	if (fabs(mouseClickPoint.x() - event->pos().x()) > clickAllowableOffset || 
@@ -275,14 +295,19 @@ void MarkingPlot::horizontalClickEvent(double pos)
 {
 	const bool bNeedAttachMarker = markerAttachRules[EAxis::EA_xAxis];
 
-	if (bNeedAttachMarker && graphCount() >= 0)
+	if (bNeedAttachMarker && graphCount() > 0)
 	{
-		for (auto point = graph(0)->data()->constBegin(); point != graph(0)->data()->constEnd(); ++point)
+		//keys are sorted, the first key within reach is at the lower bound or just after keys equal to it
+		const QCPGraph* attachGraph = graph(0);
+		const int count = attachGraph->dataCount();
+		int index = attachGraph->findBegin(pos - 0.5, false);
+		while (index < count && attachGraph->dataMainKey(index) - pos <= -0.5)
 		{
-			if (fabs(point->key - pos) < 0.5) {
-				pos = point->key;
-				break;
-			}
+			index++;
+		}
+		if (index < count && fabs(attachGraph->dataMainKey(index) - pos) < 0.5)
+		{
+			pos = attachGraph->dataMainKey(index);
 		}
 	}
 
@@ -352,12 +377,15 @@ void MarkingPlot::verticalClickEvent(double pos)
 {
 	const bool bNeedAttachMarker = markerAttachRules[EAxis::EA_yAxis];
 
-	if (bNeedAttachMarker && graphCount() >= 0)
+	if (bNeedAttachMarker && graphCount() > 0)
 	{
-		for (auto point = graph(0)->data()->constBegin(); point != graph(0)->data()->constEnd(); ++point)
+		const QCPGraph* attachGraph = graph(0);
+		const int count = attachGraph->dataCount();
+		for (int index = 0; index < count; index++)
 		{
-			if (fabs(point->value - pos) < 0.5) {
-				pos = point->value;
+			const double value = attachGraph->dataMainValue(index);
+			if (fabs(value - pos) < 0.5) {
+				pos = value;
 				break;
 			}
 		}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ZoomClampedPlot.h"
+#include "PlotInteractionScheduler.h"
 
 
 //Forward Declaration
@@ -55,6 +56,7 @@ protected:
 
 	void mousePressEvent(QMouseEvent* event) override;
 	void mouseReleaseEvent(QMouseEvent* event) override;
+	void mouseMoveEvent(QMouseEvent* event) override;
 
 	virtual void horizontalClickEvent(double pos);
 	virtual void verticalClickEvent(double pos);
@@ -136,5 +138,11 @@ public:
 private:
 	bool bIsAlreadyDragging = false;
 
+public:
+	inline PlotInteractionScheduler* getInteractionScheduler() const { return interactionScheduler; }
+
+private:
+	PlotInteractionScheduler* interactionScheduler;
+
 };
 
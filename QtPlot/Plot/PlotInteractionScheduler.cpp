@@ -0,0 +1,125 @@
+#include "PlotInteractionScheduler.h"
+
+#include "QCustomPlot/QCustomPlot.h"
+
+#include <QtMath>
+
+
+double PlotInteractionStats::meanUs() const
+{
+	return frames > 0 ? totalNs / 1000.0 / frames : 0.0;
+}
+
+PlotInteractionScheduler::PlotInteractionScheduler(QCustomPlot* plot)
+	: QObject(plot), plot(plot)
+{
+	frameTimer.setSingleShot(true);
+	connect(&frameTimer, &QTimer::timeout, this, &PlotInteractionScheduler::dispatch);
+}
+
+PlotInteractionScheduler::~PlotInteractionScheduler()
+{
+}
+
+void PlotInteractionScheduler::setEnabled(bool inEnabled)
+{
+	if (enabled == inEnabled) return;
+
+	//deliver what is pending before switching to direct handling
+	flush();
+	enabled = inEnabled;
+}
+
+void PlotInteractionScheduler::setFrameInterval(int ms)
+{
+	frameInterval = qBound(1, ms, static_cast<int>(MaxFrameInterval));
+	nextInterval = frameInterval;
+}
+
+void PlotInteractionScheduler::setFrameBudget(int ms)
+{
+	frameBudget = qMax(1, ms);
+}
+
+void PlotInteractionScheduler::postMouseMove(QMouseEvent* event)
+{
+	if (!pendingEvent.isNull())
+	{
+		stats.coalesced++;
+	}
+	pendingEvent.reset(new QMouseEvent(*event));
+
+	if (frameTimer.isActive()) return;
+
+	//the first move after a pause goes out on the next event loop turn
+	const qint64 elapsed = sinceDispatch.isValid() ? sinceDispatch.elapsed() : nextInterval;
+	frameTimer.start(static_cast<int>(qMax<qint64>(0, nextInterval - elapsed)));
+}
+
+void PlotInteractionScheduler::flush()
+{
+	frameTimer.stop();
+	dispatch();
+}
+
+void PlotInteractionScheduler::replotLayer(const QString& layerName)
+{
+	if (dispatching)
+	{
+		if (pendingLayers.contains(layerName))
+		{
+			stats.deferredReplots++;
+		}
+		else
+		{
+			pendingLayers.append(layerName);
+		}
+		return;
+	}
+
+	QCPLayer* layer = plot->layer(layerName);
+	if (layer)
+	{
+		layer->replot();
+	}
+}
+
+void PlotInteractionScheduler::resetStats()
+{
+	stats = PlotInteractionStats();
+}
+
+void PlotInteractionScheduler::dispatch()
+{
+	if (pendingEvent.isNull() || dispatching) return;
+
+	QScopedPointer<QMouseEvent> event(pendingEvent.take());
+
+	QElapsedTimer costTimer;
+	costTimer.start();
+
+	dispatching = true;
+	emit mouseMoveReady(event.data());
+	dispatching = false;
+
+	const QStringList layers = pendingLayers;
+	pendingLayers.clear();
+	for (const QString& layerName : layers)
+	{
+		replotLayer(layerName);
+	}
+
+	const qint64 cost = costTimer.nsecsElapsed();
+	stats.frames++;
+	stats.lastNs = cost;
+	stats.maxNs = qMax(stats.maxNs, cost);
+	stats.totalNs += cost;
+
+	//stretch the next frame so that cost / interval stays within budget / frameInterval
+	const double costMs = cost / 1.0e6;
+	nextInterval = costMs > frameBudget
+		? qMin(static_cast<int>(MaxFrameInterval), qCeil(costMs * frameInterval / frameBudget))
+		: frameInterval;
+
+	sinceDispatch.start();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include "QtPlotGlobal.h"
+
+class QCustomPlot;
+
+
+/*!
+\brief Handler cost of the coalesced mouse moves of one plot
+*/
+struct QTPLOT_EXPORT PlotInteractionStats
+{
+	quint64 frames = 0;			//dispatched mouse moves
+	quint64 coalesced = 0;		//raw mouse moves replaced by a later one before dispatch
+	quint64 deferredReplots = 0;	//layer replots merged into the end of a dispatch
+	qint64 lastNs = 0;
+	qint64 maxNs = 0;
+	qint64 totalNs = 0;
+
+	double meanUs() const;
+};
+
+
+/*!
+\brief Per-plot mouse move coalescing
+
+Raw mouse moves are not handled one by one: the latest one is kept and dispatched at most once per frame.
+Layer replots requested while dispatching (replotLayer) are deferred to the end of the dispatch
+and done once per layer, however many handlers asked for them.
+
+The dispatch time, handlers and replots, is measured. When it exceeds the frame budget the next dispatch
+is delayed accordingly, so mouse handling takes at most budget / frame interval of the GUI thread
+and leaves the rest to data rendering.
+*/
+class QTPLOT_EXPORT PlotInteractionScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit PlotInteractionScheduler(QCustomPlot* plot);
+	~PlotInteractionScheduler() override;
+
+	void setEnabled(bool enabled);
+	inline bool isEnabled() const { return enabled; }
+
+	void setFrameInterval(int ms);
+	inline int getFrameInterval() const { return frameInterval; }
+
+	void setFrameBudget(int ms);
+	inline int getFrameBudget() const { return frameBudget; }
+
+	void postMouseMove(QMouseEvent* event);
+
+	/*!
+	\brief Dispatch the pending mouse move now, called before press and release to keep the event order
+	*/
+	void flush();
+
+	void replotLayer(const QString& layerName);
+	inline bool isDispatching() const { return dispatching; }
+
+	inline PlotInteractionStats getStats() const { return stats; }
+	void resetStats();
+
+signals:
+	void mouseMoveReady(QMouseEvent* event);
+
+private slots:
+	void dispatch();
+
+private:
+	enum { MaxFrameInterval = 250 };
+
+	QCustomPlot*				plot;
+
+	QTimer						frameTimer;
+	QElapsedTimer				sinceDispatch;
+	QScopedPointer<QMouseEvent>	pendingEvent;
+	QStringList					pendingLayers;
+
+	bool						enabled = true;
+	bool						dispatching = false;
+	int							frameInterval = 16;
+	int							frameBudget = 8;
+	int							nextInterval = 16;
+
+	PlotInteractionStats		stats;
+
+};
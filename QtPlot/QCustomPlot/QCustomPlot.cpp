@@ -13486,6 +13486,12 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   \see replot, beforeReplot, afterLayout
 */
 
+/*! \fn void QCustomPlot::refinementFinished()
+  
+  This signal is emitted when the graphs that were drawn as a preview (see \ref
+  setProgressiveRendering) have been refined and the full quality result is shown.
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -13614,6 +13620,9 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(nullptr),
   mOpenGl(false),
+  mProgressiveRendering(false),
+  mProgressiveTimeSlice(10),
+  mProgressivePreviewSize(20000),
   mMouseHasMoved(false),
   mMouseEventLayerable(nullptr),
   mMouseSignalLayerable(nullptr),
@@ -13623,7 +13632,9 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mReplotTimeAverage(0),
   mOpenGlMultisamples(16),
   mOpenGlAntialiasedElementsBackup(QCP::aeNone),
-  mOpenGlCacheLabelsBackup(true)
+  mOpenGlCacheLabelsBackup(true),
+  mRefineTimer(nullptr),
+  mComposingRefinement(false)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -13642,6 +13653,10 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   
   mOpenGlAntialiasedElementsBackup = mAntialiasedElements;
   mOpenGlCacheLabelsBackup = mPlottingHints.testFlag(QCP::phCacheLabels);
+  // refinement of progressively rendered graphs runs in the event loop, one time slice per turn:
+  mRefineTimer = new QTimer(this);
+  mRefineTimer->setSingleShot(true);
+  connect(mRefineTimer, SIGNAL(timeout()), this, SLOT(processRefinement()));
   // create initial layers:
   mLayers.append(new QCPLayer(this, QLatin1String("background")));
   mLayers.append(new QCPLayer(this, QLatin1String("grid")));
@@ -14098,6 +14113,58 @@ void QCustomPlot::setOpenGl(bool enabled, int multisampling)
 #endif
 }
 
+/*!
+  Enables progressive rendering of large graphs. A graph with more visible data points than \ref
+  setProgressivePreviewSize is drawn as a coarse preview during \ref replot, so the replot returns
+  quickly. With envelope sampling (\ref QCPGraph::setEnvelopeSampling), the preview keeps the first
+  and last data point and the value range of each bucket of consecutive data points, so peaks
+  aren't lost while the refinement is pending, otherwise it shows evenly picked data points. The
+  full quality graph is then drawn in the following event
+  loop turns into an offscreen image, at most \ref setProgressiveTimeSlice milliseconds per turn.
+  When all graphs are done, their layers are redrawn with the finished images (only the graph's
+  layer if it is in \ref QCPLayer::lmBuffered mode, else the whole plot) and \ref
+  refinementFinished is emitted.
+  
+  Every replot drops a running refinement and starts a new one from the current view, a refinement
+  is also dropped if the axis ranges or the data changed in between. Plots which replot faster
+  than the refinement completes, like streaming traces, therefore show the preview. Exports (\ref toPixmap,
+  \ref savePng, etc.) always draw the graphs in full quality.
+  
+  Refinement time slices end at the next step. The lines and scatters of a segment are computed
+  from chunks of data points and drawn in chunks of pixel points, each chunk is one step, and so is
+  the fill of a segment.
+  
+  \see isRefining
+*/
+void QCustomPlot::setProgressiveRendering(bool enabled)
+{
+  mProgressiveRendering = enabled;
+  if (!mProgressiveRendering)
+    cancelRefinements();
+}
+
+/*!
+  Sets the time in milliseconds the refinement of progressively rendered graphs may take per event
+  loop turn.
+  
+  \see setProgressiveRendering
+*/
+void QCustomPlot::setProgressiveTimeSlice(int msecs)
+{
+  mProgressiveTimeSlice = qMax(1, msecs);
+}
+
+/*!
+  Sets the number of visible data points above which a graph is rendered progressively, this is
+  also about the number of data points per segment drawn in the preview.
+  
+  \see setProgressiveRendering
+*/
+void QCustomPlot::setProgressivePreviewSize(int points)
+{
+  mProgressivePreviewSize = qMax(2, points);
+}
+
 /*!
   Sets the viewport of this QCustomPlot. Usually users of QCustomPlot don't need to change the
   viewport manually.
@@ -15130,6 +15197,10 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotQueued = false;
   emit beforeReplot();
   
+  // the graphs start over from the current view, unless this replot shows their finished refinement:
+  if (!mComposingRefinement)
+    cancelRefinements();
+  
 # if QT_VERSION < QT_VERSION_CHECK(4, 8, 0)
   QTime replotTimer;
   replotTimer.start();
@@ -15139,12 +15210,17 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 # endif
   
   updateLayout();
+  // compute the graph geometries in parallel, the graphs pick them up when drawn below:
+  if (mPlottingHints.testFlag(QCP::phParallelGeometry))
+    prepareGraphGeometry();
   // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
   setupPaintBuffers();
   foreach (QCPLayer *layer, mLayers)
     layer->drawToPaintBuffer();
   foreach (QSharedPointer<QCPAbstractPaintBuffer> buffer, mPaintBuffers)
     buffer->setInvalidated(false);
+  if (mPlottingHints.testFlag(QCP::phParallelGeometry))
+    releaseGraphGeometry();
   
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
@@ -15855,6 +15931,203 @@ void QCustomPlot::setupPaintBuffers()
   }
 }
 
+namespace {
+
+/*! \internal
+
+  Worker of \ref QCustomPlot::prepareGraphGeometry. All workers take graphs from the same list
+  through a shared counter until the list is exhausted, each graph is computed by exactly one of
+  them. If \a done is set, it is released once the worker has finished.
+*/
+class QCPGeometryTask : public QRunnable
+{
+public:
+  QCPGeometryTask(const QList<QCPGraph*> *graphs, QAtomicInt *next, QSemaphore *done) :
+    mGraphs(graphs), mNext(next), mDone(done)
+  {
+    setAutoDelete(false);
+  }
+  
+  virtual void run() Q_DECL_OVERRIDE
+  {
+    int index;
+    while ((index = mNext->fetchAndAddOrdered(1)) < mGraphs->size())
+      mGraphs->at(index)->computeGeometry();
+    if (mDone)
+      mDone->release();
+  }
+  
+private:
+  const QList<QCPGraph*> *mGraphs;
+  QAtomicInt *mNext;
+  QSemaphore *mDone;
+};
+
+} // namespace
+
+/*! \internal
+
+  Computes the pixel geometry of all visible graphs on the global thread pool, if the \ref
+  QCP::phParallelGeometry plotting hint is set. This is called in \ref replot after the layout was
+  updated, so the axis rects have their final size.
+
+  The graph properties are read on the GUI thread first (\ref QCPGraph::prepareGeometry), the
+  workers then only run the const line and scatter data generation of their graph. The calling
+  thread takes part in the work, so the geometry is complete even if the pool is busy. The result
+  of a graph doesn't depend on the thread it was computed on, drawing is identical to the serial
+  path.
+
+  \see releaseGraphGeometry
+*/
+void QCustomPlot::prepareGraphGeometry()
+{
+  QList<QCPGraph*> graphs;
+  foreach (QCPGraph *graph, mGraphs)
+  {
+    if (graph->realVisibility() && !graph->progressivePreview() && !graph->mRefinement && graph->prepareGeometry())
+      graphs.append(graph);
+  }
+  if (graphs.size() < 2) // nothing to distribute, the graph computes its geometry when drawn
+  {
+    foreach (QCPGraph *graph, graphs)
+      graph->releaseGeometry();
+    return;
+  }
+  
+  QThreadPool *pool = QThreadPool::globalInstance();
+  QAtomicInt next(0);
+  QSemaphore done;
+  QVector<QCPGeometryTask*> tasks;
+  const int helperCount = qMin(graphs.size(), pool->maxThreadCount())-1;
+  for (int i=0; i<helperCount; ++i)
+  {
+    tasks.append(new QCPGeometryTask(&graphs, &next, &done));
+    pool->start(tasks.last());
+  }
+  QCPGeometryTask(&graphs, &next, nullptr).run();
+  
+  // tasks that didn't start yet are taken back, only the running ones are waited for:
+  int runningCount = 0;
+  foreach (QCPGeometryTask *task, tasks)
+  {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    if (!pool->tryTake(task))
+#endif
+      ++runningCount;
+  }
+  done.acquire(runningCount);
+  qDeleteAll(tasks);
+}
+
+/*! \internal
+
+  Discards the geometry computed by \ref prepareGraphGeometry that wasn't consumed while drawing,
+  e.g. for graphs on layers that weren't drawn. Later draws (export, single layer replots) then
+  use the serial path again.
+*/
+void QCustomPlot::releaseGraphGeometry()
+{
+  foreach (QCPGraph *graph, mGraphs)
+    graph->releaseGeometry();
+}
+
+/*! \internal
+
+  Called by a graph that drew a preview, schedules its refinement in \ref processRefinement.
+
+  \see setProgressiveRendering
+*/
+void QCustomPlot::registerRefinement(QCPGraph *graph)
+{
+  if (!mRefiningGraphs.contains(graph))
+    mRefiningGraphs.append(graph);
+  if (!mRefineTimer->isActive())
+    mRefineTimer->start(0);
+}
+
+/*! \internal
+
+  Drops the refinement of all graphs, the previews stay as they are until the next replot.
+*/
+void QCustomPlot::cancelRefinements()
+{
+  foreach (QPointer<QCPGraph> graph, mRefiningGraphs)
+  {
+    if (graph)
+      graph->cancelRefinement();
+  }
+  mRefiningGraphs.clear();
+  mRefineTimer->stop();
+}
+
+/*! \internal
+
+  Refines the graphs registered with \ref registerRefinement for one time slice (\ref
+  setProgressiveTimeSlice), one graph after the other. Once all of them are finished, their layers
+  are redrawn: the graphs draw their refined images there instead of a new preview.
+*/
+void QCustomPlot::processRefinement()
+{
+  QElapsedTimer timer;
+  timer.start();
+  bool finished = true;
+  for (int i=0; i<mRefiningGraphs.size(); )
+  {
+    QCPGraph *graph = mRefiningGraphs.at(i).data();
+    if (!graph || !graph->mRefinement || !graph->refinementMatchesView()) // graph removed, redrawn or view changed without a replot
+    {
+      if (graph)
+        graph->cancelRefinement();
+      mRefiningGraphs.removeAt(i);
+      continue;
+    }
+    if (!graph->refine(timer, mProgressiveTimeSlice))
+    {
+      finished = false;
+      break;
+    }
+    ++i;
+  }
+  if (!finished)
+  {
+    mRefineTimer->start(0);
+    return;
+  }
+  if (mRefiningGraphs.isEmpty())
+    return;
+  
+  // show the refined graphs, a layer of its own is enough for buffered layers:
+  const QList<QPointer<QCPGraph> > refinedGraphs = mRefiningGraphs;
+  mRefiningGraphs.clear(); // graphs that start a new preview while composing register again
+  QList<QCPLayer*> layers;
+  bool fullReplot = false;
+  foreach (QPointer<QCPGraph> graph, refinedGraphs)
+  {
+    QCPLayer *graphLayer = graph->layer();
+    if (graphLayer && graphLayer->mode() == QCPLayer::lmBuffered)
+    {
+      if (!layers.contains(graphLayer))
+        layers.append(graphLayer);
+    } else
+      fullReplot = true;
+  }
+  mComposingRefinement = true;
+  if (fullReplot)
+    replot();
+  else
+  {
+    foreach (QCPLayer *graphLayer, layers)
+      graphLayer->replot();
+  }
+  mComposingRefinement = false;
+  foreach (QPointer<QCPGraph> graph, refinedGraphs)
+  {
+    if (graph && graph->mRefinement && graph->mRefinement->ready) // drawn now or hidden, either way outdated
+      graph->cancelRefinement();
+  }
+  emit refinementFinished();
+}
+
 /*! \internal
 
   This method is used by \ref setupPaintBuffers when it needs to create new paint buffers.
@@ -20793,149 +21066,978 @@ QCPGraphData::QCPGraphData(double key, double value) :
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPGraph
+//////////////////// QCPGraphEnvelope
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPGraph
-  \brief A plottable representing a graph in a plot.
-
-  \image html QCPGraph.png
-  
-  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
-  accessed via QCustomPlot::graph.
-
-  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
-  also access and modify the data via the \ref data method, which returns a pointer to the internal
-  \ref QCPGraphDataContainer.
-  
-  Graphs are used to display single-valued data. Single-valued means that there should only be one
-  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
-  want to plot non-single-valued curves, rather use the QCPCurve plottable.
-  
-  Gaps in the graph line can be created by adding data points with NaN as value
-  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
-  separated.
-  
-  \section qcpgraph-appearance Changing the appearance
-  
-  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
-  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
-  
-  \subsection filling Filling under or between graphs
-  
-  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
-  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
-  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
-  
-  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
-  between this graph and another one, call \ref setChannelFillGraph with the other graph as
-  parameter.
+/*! \class QCPGraphEnvelope
+  \brief Multi-level min/max summary of a QCPGraphDataContainer
 
-  \see QCustomPlot::addGraph, QCustomPlot::graph
-*/
+  Level 0 holds the value range of every block of \c BaseBlockSize consecutive data points, each
+  higher level merges 4 blocks of the level below. The value range of any index range is then
+  assembled from O(log n) blocks plus at most a few raw data points at both ends (\ref valueRange).
 
-/* start of documentation of inline functions */
+  Blocks are aligned to the running index of the data points (\ref
+  QCPDataContainer::frontIndex), so appending data points only summarizes the new ones and
+  removing data points from the front, as done by a ring buffer or \ref
+  QCPDataContainer::removeBefore, doesn't touch the summary at all. Any other change of the
+  container (see \ref QCPDataContainer::revision) makes the next \ref update rebuild it.
 
-/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
-  
-  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
-  use it to directly manipulate the data, which may be more convenient and faster than using the
-  regular \ref setData or \ref addData methods.
+  It is used by QCPGraph when \ref QCPGraph::setEnvelopeSampling is enabled.
 */
 
-/* end of documentation of inline functions */
+QCPGraphEnvelope::QCPGraphEnvelope() :
+  mData(nullptr),
+  mRevision(0),
+  mEnd(0)
+{
+}
 
 /*!
-  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
-  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
-  the same orientation. If either of these restrictions is violated, a corresponding message is
-  printed to the debug output (qDebug), the construction is not aborted, though.
-  
-  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
-  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
-  but use QCustomPlot::removePlottable() instead.
-  
-  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
+  Drops the summary, the next \ref update rebuilds it.
 */
-QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
-  mLineStyle{},
-  mScatterSkip{},
-  mAdaptiveSampling{}
+void QCPGraphEnvelope::clear()
 {
-  // special handling for QCPGraphs to maintain the simple graph interface:
-  mParentPlot->registerGraph(this);
-
-  setPen(QPen(Qt::blue, 0));
-  setBrush(Qt::NoBrush);
-  
-  setLineStyle(lsLine);
-  setScatterSkip(0);
-  setChannelFillGraph(nullptr);
-  setAdaptiveSampling(true);
+  mData = nullptr;
+  mLevels.clear();
 }
 
-QCPGraph::~QCPGraph()
+/*!
+  Brings the summary up to date with \a data. Data points appended since the last call are
+  summarized, everything is rebuilt if \a data was changed otherwise or is a different container.
+*/
+void QCPGraphEnvelope::update(const QCPGraphDataContainer *data)
 {
-}
-
-/*! \overload
-  
-  Replaces the current data container with the provided \a data container.
+  if (!data)
+  {
+    clear();
+    return;
+  }
   
-  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
-  Modifying the data in the container will then affect all graphs that share the container. Sharing
-  can be achieved by simply exchanging the data containers wrapped in shared pointers:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
+  const qint64 front = data->frontIndex();
+  const qint64 end = front+data->size();
+  if (data != mData || data->revision() != mRevision || front > mEnd || end < mEnd)
+  {
+    mData = data;
+    mRevision = data->revision();
+    mLevels.clear();
+    mEnd = front;
+  }
   
-  If you do not wish to share containers, but create a copy from an existing container, rather use
-  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
+  // release blocks which lie entirely before the first data point, they are never used again:
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    Level &current = mLevels[level];
+    const int unused = int(qMin(qint64(current.blocks.size()), front/blockSize(level)-current.firstBlock));
+    if (unused > 0 && (unused >= 1024 || 2*unused >= current.blocks.size()))
+    {
+      current.blocks.remove(0, unused);
+      current.firstBlock += unused;
+    }
+  }
   
-  \see addData
-*/
-void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
-{
-  mDataContainer = data;
-}
-
-/*! \overload
+  if (end == mEnd)
+    return;
   
-  Replaces the current data with the provided points in \a keys and \a values. The provided
-  vectors should have equal length. Else, the number of added points will be the size of the
-  smallest vector.
+  // level 0 from the new data points:
+  if (mLevels.isEmpty())
+  {
+    Level base;
+    base.firstBlock = mEnd/BaseBlockSize;
+    mLevels.append(base);
+  }
+  Level &base = mLevels[0];
+  QCPGraphDataContainer::const_iterator it = data->constBegin()+int(mEnd-front);
+  for (qint64 index=mEnd; index<end; ++index, ++it)
+  {
+    const int block = int(index/BaseBlockSize-base.firstBlock);
+    if (block == base.blocks.size())
+      base.blocks.append(QCPRange(qQNaN(), qQNaN()));
+    expand(base.blocks[block], it->value);
+  }
   
-  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
-  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  // higher levels, from the first changed block of the level below:
+  qint64 changedFrom = mEnd;
+  for (int level=1; level<MaxLevels; ++level)
+  {
+    const Level &below = mLevels.at(level-1);
+    if (level == mLevels.size())
+    {
+      if (below.blocks.size() <= (1<<LevelShift)) // the level below is small enough to be the top
+        break;
+      Level top;
+      top.firstBlock = below.firstBlock >> LevelShift;
+      mLevels.append(top);
+      changedFrom = top.firstBlock*blockSize(level);
+    }
+    
+    Level &current = mLevels[level];
+    const Level &children = mLevels.at(level-1);
+    const qint64 size = blockSize(level);
+    const qint64 firstParent = qMax(current.firstBlock, changedFrom/size);
+    const qint64 lastParent = (end-1)/size;
+    for (qint64 parent=firstParent; parent<=lastParent; ++parent)
+    {
+      QCPRange range(qQNaN(), qQNaN());
+      for (qint64 child=parent<<LevelShift; child<((parent+1)<<LevelShift); ++child)
+      {
+        const qint64 childIndex = child-children.firstBlock;
+        if (childIndex >= 0 && childIndex < children.blocks.size())
+          expand(range, children.blocks.at(int(childIndex)));
+      }
+      const int block = int(parent-current.firstBlock);
+      if (block == current.blocks.size())
+        current.blocks.append(range);
+      else
+        current.blocks[block] = range;
+    }
+    changedFrom = firstParent*size;
+  }
   
-  \see addData
-*/
-void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
-{
-  mDataContainer->clear();
-  addData(keys, values, alreadySorted);
+  mEnd = end;
 }
 
 /*!
-  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
-  \ref lsNone and \ref setScatterStyle to the desired scatter style.
-  
-  \see setScatterStyle
-*/
-void QCPGraph::setLineStyle(LineStyle ls)
-{
-  mLineStyle = ls;
-}
+  Returns the range of the values of the data points [\a begin, \a end) of \a data, NaN values are
+  ignored. If all values are NaN, both bounds of the returned range are NaN.
 
-/*!
-  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
-  are drawn (e.g. for line-only-plots with appropriate line style).
-  
-  \see QCPScatterStyle, setLineStyle
+  \a data must be the container passed to the last \ref update, unchanged since.
 */
-void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+QCPRange QCPGraphEnvelope::valueRange(const QCPGraphDataContainer *data, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const
 {
-  mScatterStyle = style;
+  QCPRange range(qQNaN(), qQNaN());
+  const qint64 front = data->frontIndex();
+  qint64 index = front+(begin-data->constBegin());
+  const qint64 last = front+(end-data->constBegin());
+  
+  while (index < last)
+  {
+    // largest block starting at index that lies entirely within the range:
+    int level = mLevels.size()-1;
+    for (; level >= 0; --level)
+    {
+      const qint64 size = blockSize(level);
+      if (index % size == 0 && index+size <= last)
+      {
+        const qint64 block = index/size-mLevels.at(level).firstBlock;
+        if (block >= 0 && block < mLevels.at(level).blocks.size())
+        {
+          expand(range, mLevels.at(level).blocks.at(int(block)));
+          index += size;
+          break;
+        }
+      }
+    }
+    if (level < 0) // no block fits, use the data point itself
+    {
+      expand(range, (data->constBegin()+int(index-front))->value);
+      ++index;
+    }
+  }
+  return range;
+}
+
+/*! \internal
+  
+  Expands \a range to include \a value, unless it is NaN. A range with NaN bounds is empty.
+*/
+void QCPGraphEnvelope::expand(QCPRange &range, double value)
+{
+  if (qIsNaN(value))
+    return;
+  if (qIsNaN(range.lower))
+  {
+    range.lower = value;
+    range.upper = value;
+  } else if (value < range.lower)
+    range.lower = value;
+  else if (value > range.upper)
+    range.upper = value;
+}
+
+/*! \internal
+  
+  Expands \a range to include \a other, empty ranges (NaN bounds) are ignored.
+*/
+void QCPGraphEnvelope::expand(QCPRange &range, const QCPRange &other)
+{
+  if (qIsNaN(other.lower))
+    return;
+  if (qIsNaN(range.lower))
+    range = other;
+  else
+  {
+    if (other.lower < range.lower)
+      range.lower = other.lower;
+    if (other.upper > range.upper)
+      range.upper = other.upper;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphDataSource
+  \brief Non-owning view on key and value arrays, drawn by a QCPGraph without copying
+
+  A data source references structure-of-arrays data that lives outside of the plot: a value array
+  of \c double or \c float and either a key array of the same element types or implicit uniform
+  keys (<tt>keyStart + i*keyStep</tt>), as produced by sampled signals. It is passed by value and
+  assigned to a graph with \ref QCPGraph::setDataSource.
+
+  The graph reads the arrays directly when drawing, sampling, hit testing and rescaling, so data
+  that is already held in such arrays doesn't have to be converted to a \ref QCPGraphDataContainer
+  first. The sampling loops are instantiated once per key and value type, there is no per point
+  dispatch.
+
+  The arrays are not copied: they must stay valid and unchanged while the source is assigned to a
+  graph. The keys must be sorted ascending and the uniform \a keyStep must be positive. After
+  changing the contents or the size of the arrays, assign the updated source again (or just call
+  \ref QCustomPlot::replot if only the contents changed).
+*/
+
+namespace {
+
+/* Typed views on the arrays of a QCPGraphDataSource, the sampling loops are templates over them.
+   operator() returns the element at an index, lowerBound/upperBound search the index range
+   [first, last) like std::lower_bound/std::upper_bound. */
+template <typename T>
+struct QCPSourceArray
+{
+  explicit QCPSourceArray(const T *data) : data(data) {}
+  double operator()(int index) const { return double(data[index]); }
+  int lowerBound(int first, int last, double key) const { return int(std::lower_bound(data+first, data+last, key)-data); }
+  int upperBound(int first, int last, double key) const { return int(std::upper_bound(data+first, data+last, key)-data); }
+  const T *data;
+};
+
+struct QCPSourceUniformKeys
+{
+  QCPSourceUniformKeys(double start, double step) : start(start), step(step) {}
+  double operator()(int index) const { return start+index*step; }
+  int lowerBound(int first, int last, double key) const
+  {
+    int index = guess(first, last, std::ceil((key-start)/step));
+    while (index > first && (*this)(index-1) >= key) // correct rounding of the guess
+      --index;
+    while (index < last && (*this)(index) < key)
+      ++index;
+    return index;
+  }
+  int upperBound(int first, int last, double key) const
+  {
+    int index = guess(first, last, std::floor((key-start)/step)+1);
+    while (index > first && (*this)(index-1) > key) // correct rounding of the guess
+      --index;
+    while (index < last && (*this)(index) <= key)
+      ++index;
+    return index;
+  }
+  static int guess(int first, int last, double position)
+  {
+    if (!(position > first)) // also catches NaN
+      return first;
+    return position < last ? int(position) : last;
+  }
+  double start, step;
+};
+
+/* Views on a QCPGraphDataContainer, indices count from base. The container is sampled by the same
+   templates as the arrays of a data source. */
+struct QCPContainerKeys
+{
+  explicit QCPContainerKeys(const QCPGraphDataContainer::const_iterator &base) : base(base) {}
+  double operator()(int index) const { return (base+index)->key; }
+  int lowerBound(int first, int last, double key) const { return int(std::lower_bound(base+first, base+last, QCPGraphData::fromSortKey(key), qcpLessThanSortKey<QCPGraphData>)-base); }
+  QCPGraphDataContainer::const_iterator base;
+};
+
+struct QCPContainerValues
+{
+  explicit QCPContainerValues(const QCPGraphDataContainer::const_iterator &base) : base(base) {}
+  double operator()(int index) const { return (base+index)->value; }
+  QCPGraphDataContainer::const_iterator base;
+};
+
+/* Values of the graph's own container, whose value ranges are read from its envelope. base must
+   be an iterator of data. */
+struct QCPEnvelopeValues : public QCPContainerValues
+{
+  QCPEnvelopeValues(const QCPGraphDataContainer::const_iterator &base, const QCPGraphEnvelope *envelope, const QCPGraphDataContainer *data) :
+    QCPContainerValues(base), envelope(envelope), data(data) {}
+  const QCPGraphEnvelope *envelope;
+  const QCPGraphDataContainer *data;
+};
+
+/* Value range of the data points [first, last) of a pixel column, first may not exceed last-1 */
+template <class Values>
+QCPRange qcpClusterValueRange(const Values &values, int first, int last)
+{
+  QCPRange range(values(first), values(first));
+  for (int i=first+1; i<last; ++i)
+  {
+    const double current = values(i);
+    if (current < range.lower)
+      range.lower = current;
+    else if (current > range.upper)
+      range.upper = current;
+  }
+  return range;
+}
+
+inline QCPRange qcpClusterValueRange(const QCPEnvelopeValues &values, int first, int last)
+{
+  return values.envelope->valueRange(values.data, values.base+first, values.base+last);
+}
+
+/* Calls visitor(keys, values) with the typed views matching the types of source */
+template <class Keys, class Visitor>
+void qcpVisitSourceValues(const QCPGraphDataSource &source, const Keys &keys, Visitor &visitor)
+{
+  if (source.valueType() == QCPGraphDataSource::vtFloat)
+    visitor(keys, QCPSourceArray<float>(source.floatValues()));
+  else
+    visitor(keys, QCPSourceArray<double>(source.doubleValues()));
+}
+
+template <class Visitor>
+void qcpVisitSource(const QCPGraphDataSource &source, Visitor &visitor)
+{
+  switch (source.keyType())
+  {
+    case QCPGraphDataSource::ktDouble: qcpVisitSourceValues(source, QCPSourceArray<double>(source.doubleKeys()), visitor); break;
+    case QCPGraphDataSource::ktFloat: qcpVisitSourceValues(source, QCPSourceArray<float>(source.floatKeys()), visitor); break;
+    case QCPGraphDataSource::ktUniform: qcpVisitSourceValues(source, QCPSourceUniformKeys(source.keyStart(), source.keyStep()), visitor); break;
+  }
+}
+
+struct QCPSourceSearch
+{
+  template <class Keys, class Values>
+  void operator()(const Keys &keys, const Values &) { result = upper ? keys.upperBound(0, size, key) : keys.lowerBound(0, size, key); }
+  double key;
+  bool upper;
+  int size;
+  int result;
+};
+
+struct QCPSourceValueRange
+{
+  template <class Keys, class Values>
+  void operator()(const Keys &keys, const Values &values)
+  {
+    for (int i=begin; i<end; ++i)
+    {
+      const double current = values(i);
+      if (qIsNaN(current) || (signDomain == QCP::sdNegative && current >= 0) || (signDomain == QCP::sdPositive && current <= 0))
+        continue;
+      if (restrictKeyRange && (keys(i) < keyRange.lower || keys(i) > keyRange.upper))
+        continue;
+      if (current < range.lower || !found)
+        range.lower = current;
+      if (current > range.upper || !found)
+        range.upper = current;
+      found = true;
+    }
+  }
+  int begin, end;
+  QCP::SignDomain signDomain;
+  bool restrictKeyRange;
+  QCPRange keyRange;
+  QCPRange range;
+  bool found;
+};
+
+/* Line sampling of QCPGraph::getOptimizedLineData and getSourceLineData, over the views of a data
+   container or the arrays of a data source. The data points of each pixel column are found by
+   binary search (or directly for uniform keys), their value range by a linear pass or from the
+   envelope. */
+struct QCPLineSampler
+{
+  template <class Keys, class Values>
+  void operator()(const Keys &keys, const Values &values)
+  {
+    if (!adaptive)
+    {
+      lineData->resize(end-begin);
+      for (int i=begin; i<end; ++i)
+        (*lineData)[i-begin] = QCPGraphData(keys(i), values(i));
+      return;
+    }
+    
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(keys(begin))+reversedRound));
+    double lastIntervalEndKey = currentIntervalStartKey;
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    
+    int i = begin;
+    while (i < end)
+    {
+      const int intervalEnd = keys.lowerBound(i+1, end, currentIntervalStartKey+keyEpsilon);
+      if (intervalEnd-i >= 2) // pixel has multiple data points, consolidate them to a cluster
+      {
+        const QCPRange valueRange = qcpClusterValueRange(values, i, intervalEnd);
+        if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, values(i)));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, valueRange.lower));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, valueRange.upper));
+        if (intervalEnd != end && keys(intervalEnd) > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, values(intervalEnd-1)));
+      } else
+        lineData->append(QCPGraphData(keys(i), values(i)));
+      
+      lastIntervalEndKey = keys(intervalEnd-1);
+      i = intervalEnd;
+      if (i != end)
+      {
+        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(keys(i))+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+      }
+    }
+  }
+  const QCPAxis *keyAxis;
+  bool adaptive;
+  int begin, end;
+  QVector<QCPGraphData> *lineData;
+};
+
+/* Scatter sampling of QCPGraph::getOptimizedScatterData and getSourceScatterData, over the views
+   of a data container or the arrays of a data source. begin is aligned to scatterModulo, only
+   every scatterModulo-th data point is a scatter candidate. */
+struct QCPScatterSampler
+{
+  template <class Keys, class Values>
+  void operator()(const Keys &keys, const Values &values)
+  {
+    if (!adaptive)
+    {
+      scatterData->reserve((end-begin+scatterModulo-1)/scatterModulo);
+      for (int i=begin; i<end; i+=scatterModulo)
+        scatterData->append(QCPGraphData(keys(i), values(i)));
+      return;
+    }
+    
+    const double valueMaxRange = valueAxis->range().upper;
+    const double valueMinRange = valueAxis->range().lower;
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(keys(begin))+reversedRound));
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    
+    int i = begin;
+    while (i < end)
+    {
+      // first scatter candidate that is outside of the current pixel:
+      int intervalEnd = keys.lowerBound(i+1, end, currentIntervalStartKey+keyEpsilon);
+      intervalEnd = i+(intervalEnd-i+scatterModulo-1)/scatterModulo*scatterModulo;
+      if (intervalEnd > end)
+        intervalEnd = end;
+      const int intervalDataCount = (intervalEnd-i+scatterModulo-1)/scatterModulo;
+      if (intervalDataCount >= 2) // pixel has multiple data points, consolidate them
+      {
+        double minValue = values(i);
+        double maxValue = minValue;
+        int minValueIndex = i;
+        int maxValueIndex = i;
+        for (int j=i+scatterModulo; j<intervalEnd; j+=scatterModulo)
+        {
+          const double current = values(j);
+          if (current < minValue && current > valueMinRange && current < valueMaxRange)
+          {
+            minValue = current;
+            minValueIndex = j;
+          } else if (current > maxValue && current > valueMinRange && current < valueMaxRange)
+          {
+            maxValue = current;
+            maxValueIndex = j;
+          }
+        }
+        // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
+        double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+        int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
+        int c = 0;
+        for (int j=i; j<intervalEnd; j+=scatterModulo, ++c)
+        {
+          const double current = values(j);
+          if ((c % dataModulo == 0 || j == minValueIndex || j == maxValueIndex) && current > valueMinRange && current < valueMaxRange)
+            scatterData->append(QCPGraphData(keys(j), current));
+        }
+      } else if (values(i) > valueMinRange && values(i) < valueMaxRange)
+        scatterData->append(QCPGraphData(keys(i), values(i)));
+      
+      i = intervalEnd;
+      if (i != end)
+      {
+        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(keys(i))+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+      }
+    }
+  }
+  const QCPAxis *keyAxis;
+  const QCPAxis *valueAxis;
+  bool adaptive;
+  int begin, end;
+  int scatterModulo;
+  QVector<QCPGraphData> *scatterData;
+};
+
+/* Preview sampling of QCPGraph::getPreviewData with envelope sampling. The data points [begin,
+   end) are split into buckets of stride data points, each bucket contributes its first and last
+   data point and, at the key of its center, the value range of the data points in between. The
+   value ranges come from the envelope, so peaks survive the decimation without a pass over the
+   values. */
+struct QCPPreviewSampler
+{
+  void operator()(const QCPContainerKeys &keys, const QCPEnvelopeValues &values)
+  {
+    for (int first=begin; first<end; first+=stride)
+    {
+      const int last = qMin(first+stride, end)-1;
+      data->append(QCPGraphData(keys(first), values(first)));
+      if (last-first > 1)
+      {
+        const QCPRange range = qcpClusterValueRange(values, first+1, last);
+        if (!qIsNaN(range.lower))
+        {
+          const double centerKey = keys((first+last)/2);
+          data->append(QCPGraphData(centerKey, range.lower));
+          if (range.upper > range.lower)
+            data->append(QCPGraphData(centerKey, range.upper));
+        }
+      }
+      if (last > first)
+        data->append(QCPGraphData(keys(last), values(last)));
+    }
+  }
+  int begin, end;
+  int stride;
+  QVector<QCPGraphData> *data;
+};
+
+/* Bucket size of QCPPreviewSampler for count data points, a bucket contributes up to four */
+inline int qcpPreviewStride(int count, int maxCount)
+{
+  const qint64 stride = (4*qint64(count)+maxCount-1)/maxCount;
+  return int(qBound(qint64(1), stride, qint64(count)));
+}
+
+/* Whether two data sources read the same arrays with the same key mapping and size */
+inline bool qcpSameSource(const QCPGraphDataSource &a, const QCPGraphDataSource &b)
+{
+  return a.keyType() == b.keyType() && a.valueType() == b.valueType() &&
+         a.doubleKeys() == b.doubleKeys() && a.floatKeys() == b.floatKeys() &&
+         a.keyStart() == b.keyStart() && a.keyStep() == b.keyStep() &&
+         a.doubleValues() == b.doubleValues() && a.floatValues() == b.floatValues() &&
+         a.size() == b.size();
+}
+
+} // namespace
+
+/*!
+  Constructs an empty data source with uniform keys starting at 0 with a step of 1.
+*/
+QCPGraphDataSource::QCPGraphDataSource() :
+  mKeyType(ktUniform),
+  mValueType(vtDouble),
+  mDoubleKeys(nullptr),
+  mFloatKeys(nullptr),
+  mKeyStart(0),
+  mKeyStep(1),
+  mDoubleValues(nullptr),
+  mFloatValues(nullptr),
+  mSize(0)
+{
+}
+
+/*!
+  Constructs a data source of \a size data points from the \a keys and \a values arrays.
+*/
+QCPGraphDataSource::QCPGraphDataSource(const double *keys, const double *values, int size) :
+  QCPGraphDataSource()
+{
+  setKeys(keys);
+  setValues(values);
+  setSize(size);
+}
+
+/*! \overload
+*/
+QCPGraphDataSource::QCPGraphDataSource(const float *keys, const float *values, int size) :
+  QCPGraphDataSource()
+{
+  setKeys(keys);
+  setValues(values);
+  setSize(size);
+}
+
+/*!
+  Constructs a data source of \a size data points from the \a values array with uniform keys, see
+  \ref setUniformKeys.
+*/
+QCPGraphDataSource::QCPGraphDataSource(double keyStart, double keyStep, const double *values, int size) :
+  QCPGraphDataSource()
+{
+  setUniformKeys(keyStart, keyStep);
+  setValues(values);
+  setSize(size);
+}
+
+/*! \overload
+*/
+QCPGraphDataSource::QCPGraphDataSource(double keyStart, double keyStep, const float *values, int size) :
+  QCPGraphDataSource()
+{
+  setUniformKeys(keyStart, keyStep);
+  setValues(values);
+  setSize(size);
+}
+
+/*!
+  Reads the keys from the array \a keys, which must hold at least \ref size elements sorted
+  ascending.
+*/
+void QCPGraphDataSource::setKeys(const double *keys)
+{
+  mKeyType = ktDouble;
+  mDoubleKeys = keys;
+  mFloatKeys = nullptr;
+}
+
+/*! \overload
+*/
+void QCPGraphDataSource::setKeys(const float *keys)
+{
+  mKeyType = ktFloat;
+  mDoubleKeys = nullptr;
+  mFloatKeys = keys;
+}
+
+/*!
+  Uses implicit keys: the key of the data point at index i is <tt>keyStart + i*keyStep</tt>. Key
+  lookups are then computed instead of searched. \a keyStep must be positive.
+*/
+void QCPGraphDataSource::setUniformKeys(double keyStart, double keyStep)
+{
+  if (!(keyStep > 0))
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << keyStep;
+    return;
+  }
+  mKeyType = ktUniform;
+  mDoubleKeys = nullptr;
+  mFloatKeys = nullptr;
+  mKeyStart = keyStart;
+  mKeyStep = keyStep;
+}
+
+/*!
+  Reads the values from the array \a values, which must hold at least \ref size elements. NaN
+  values create gaps in the graph line, as with \ref QCPGraphDataContainer.
+*/
+void QCPGraphDataSource::setValues(const double *values)
+{
+  mValueType = vtDouble;
+  mDoubleValues = values;
+  mFloatValues = nullptr;
+}
+
+/*! \overload
+*/
+void QCPGraphDataSource::setValues(const float *values)
+{
+  mValueType = vtFloat;
+  mDoubleValues = nullptr;
+  mFloatValues = values;
+}
+
+/*!
+  Sets the number of data points, the arrays must hold at least \a size elements.
+*/
+void QCPGraphDataSource::setSize(int size)
+{
+  mSize = qMax(0, size);
+}
+
+/*!
+  Same as \ref QCPDataContainer::findBegin, returns an index instead of an iterator.
+*/
+int QCPGraphDataSource::findBegin(double sortKey, bool expandedRange) const
+{
+  if (isNull() || isEmpty())
+    return 0;
+  
+  QCPSourceSearch search;
+  search.key = sortKey;
+  search.upper = false;
+  search.size = mSize;
+  qcpVisitSource(*this, search);
+  if (expandedRange && search.result > 0)
+    --search.result;
+  return search.result;
+}
+
+/*!
+  Same as \ref QCPDataContainer::findEnd, returns an index instead of an iterator.
+*/
+int QCPGraphDataSource::findEnd(double sortKey, bool expandedRange) const
+{
+  if (isNull() || isEmpty())
+    return 0;
+  
+  QCPSourceSearch search;
+  search.key = sortKey;
+  search.upper = true;
+  search.size = mSize;
+  qcpVisitSource(*this, search);
+  if (expandedRange && search.result < mSize)
+    ++search.result;
+  return search.result;
+}
+
+/*!
+  Same as \ref QCPDataContainer::keyRange. For \ref QCP::sdBoth only the outermost data points
+  with non-NaN values are read.
+*/
+QCPRange QCPGraphDataSource::keyRange(bool &foundRange, QCP::SignDomain signDomain) const
+{
+  foundRange = false;
+  if (isNull() || isEmpty())
+    return QCPRange();
+  
+  QCPRange range;
+  bool haveLower = false;
+  bool haveUpper = false;
+  if (signDomain == QCP::sdBoth) // keys are sorted, find just first and last key with non-NaN value
+  {
+    for (int i=0; i<mSize && !haveLower; ++i)
+    {
+      if (!qIsNaN(value(i)))
+      {
+        range.lower = key(i);
+        haveLower = true;
+      }
+    }
+    for (int i=mSize-1; i>=0 && !haveUpper; --i)
+    {
+      if (!qIsNaN(value(i)))
+      {
+        range.upper = key(i);
+        haveUpper = true;
+      }
+    }
+  } else
+  {
+    for (int i=0; i<mSize; ++i)
+    {
+      const double current = key(i);
+      if (qIsNaN(value(i)) || (signDomain == QCP::sdNegative && current >= 0) || (signDomain == QCP::sdPositive && current <= 0))
+        continue;
+      if (current < range.lower || !haveLower)
+      {
+        range.lower = current;
+        haveLower = true;
+      }
+      if (current > range.upper || !haveUpper)
+      {
+        range.upper = current;
+        haveUpper = true;
+      }
+    }
+  }
+  
+  foundRange = haveLower && haveUpper;
+  return range;
+}
+
+/*!
+  Same as \ref QCPDataContainer::valueRange.
+*/
+QCPRange QCPGraphDataSource::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  foundRange = false;
+  if (isNull() || isEmpty())
+    return QCPRange();
+  
+  QCPSourceValueRange valueRange;
+  valueRange.restrictKeyRange = inKeyRange != QCPRange();
+  valueRange.keyRange = inKeyRange;
+  valueRange.begin = valueRange.restrictKeyRange ? findBegin(inKeyRange.lower, false) : 0;
+  valueRange.end = valueRange.restrictKeyRange ? findEnd(inKeyRange.upper, false) : mSize;
+  valueRange.signDomain = signDomain;
+  valueRange.found = false;
+  qcpVisitSource(*this, valueRange);
+  
+  foundRange = valueRange.found;
+  return valueRange.range;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraph
+  \brief A plottable representing a graph in a plot.
+
+  \image html QCPGraph.png
+  
+  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
+  accessed via QCustomPlot::graph.
+
+  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
+  also access and modify the data via the \ref data method, which returns a pointer to the internal
+  \ref QCPGraphDataContainer.
+  
+  Graphs are used to display single-valued data. Single-valued means that there should only be one
+  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
+  want to plot non-single-valued curves, rather use the QCPCurve plottable.
+  
+  Gaps in the graph line can be created by adding data points with NaN as value
+  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
+  separated.
+  
+  Data that is already held in key and value arrays, or in a value array with uniformly spaced
+  keys, can be drawn without copying it into the container by assigning a \ref QCPGraphDataSource
+  with \ref setDataSource.
+  
+  \section qcpgraph-appearance Changing the appearance
+  
+  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
+  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
+  
+  \subsection filling Filling under or between graphs
+  
+  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
+  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
+  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  
+  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
+  between this graph and another one, call \ref setChannelFillGraph with the other graph as
+  parameter.
+
+  \see QCustomPlot::addGraph, QCustomPlot::graph
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
+  
+  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
+  use it to directly manipulate the data, which may be more convenient and faster than using the
+  regular \ref setData or \ref addData methods.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
+  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
+  the same orientation. If either of these restrictions is violated, a corresponding message is
+  printed to the debug output (qDebug), the construction is not aborted, though.
+  
+  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
+  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
+  but use QCustomPlot::removePlottable() instead.
+  
+  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
+*/
+QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
+  mLineStyle{},
+  mScatterSkip{},
+  mAdaptiveSampling{},
+  mEnvelope(nullptr),
+  mGeometryUnselectedCount(0),
+  mGeometryUnselectedScatters(false),
+  mGeometrySelectedScatters(false),
+  mGeometryReady(false),
+  mOwnedValueBoundsValid(false),
+  mSourceRevision(0),
+  mRefinement(nullptr)
+{
+  // special handling for QCPGraphs to maintain the simple graph interface:
+  mParentPlot->registerGraph(this);
+
+  setPen(QPen(Qt::blue, 0));
+  setBrush(Qt::NoBrush);
+  
+  setLineStyle(lsLine);
+  setScatterSkip(0);
+  setChannelFillGraph(nullptr);
+  setAdaptiveSampling(true);
+}
+
+QCPGraph::~QCPGraph()
+{
+  delete mEnvelope;
+  delete mRefinement;
+}
+
+/*! \overload
+  
+  Replaces the current data container with the provided \a data container.
+  
+  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
+  Modifying the data in the container will then affect all graphs that share the container. Sharing
+  can be achieved by simply exchanging the data containers wrapped in shared pointers:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
+  
+  If you do not wish to share containers, but create a copy from an existing container, rather use
+  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
+  
+  \see addData
+*/
+void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
+{
+  mDataContainer = data;
+  if (mEnvelope) // a new container may reuse the address and revision of the previous one
+    mEnvelope->clear();
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys and \a values. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+  
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  \see addData
+*/
+void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  mDataContainer->clear();
+  addData(keys, values, alreadySorted);
+}
+
+/*!
+  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
+  \ref lsNone and \ref setScatterStyle to the desired scatter style.
+  
+  \see setScatterStyle
+*/
+void QCPGraph::setLineStyle(LineStyle ls)
+{
+  mLineStyle = ls;
+}
+
+/*!
+  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
+  are drawn (e.g. for line-only-plots with appropriate line style).
+  
+  \see QCPScatterStyle, setLineStyle
+*/
+void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+{
+  mScatterStyle = style;
 }
 
 /*!
@@ -21019,6 +22121,251 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets whether adaptive sampling of lines (see \ref setAdaptiveSampling) reads the value range of
+  each pixel column from a min/max summary of the data (\ref QCPGraphEnvelope) instead of scanning
+  all visible data points.
+  
+  The summary is built on the first replot and then only extended by appended data points, so
+  zooming and panning over large data sets costs O(pixels * log n) instead of O(n) per replot. The
+  drawn line is the same as with regular adaptive sampling. It costs about 1/8 of the memory of the
+  data. Changes other than appending at the end and removing at the front (see \ref
+  QCPDataContainer::revision) cause a rebuild on the next replot.
+  
+  Scatter symbols are not affected.
+*/
+void QCPGraph::setEnvelopeSampling(bool enabled)
+{
+  if (enabled == envelopeSampling())
+    return;
+  
+  if (enabled)
+    mEnvelope = new QCPGraphEnvelope;
+  else
+  {
+    delete mEnvelope;
+    mEnvelope = nullptr;
+  }
+}
+
+/*!
+  Makes the graph read its data points from the external arrays referenced by \a source instead of
+  from its data container (\ref data). The arrays are not copied, see \ref QCPGraphDataSource for
+  their lifetime requirements.
+  
+  While a source is set, drawing, adaptive sampling, hit testing, rescaling and the 1d plottable
+  interface (\ref dataCount, \ref findBegin, etc.) all use the source, the data container is kept
+  but ignored. Code that accesses \ref data directly, like \ref QCPItemTracer, doesn't see the
+  source data. Envelope sampling (\ref setEnvelopeSampling) only applies to the data container.
+  
+  Call this again with the updated source when the arrays were reallocated or resized.
+  
+  \see clearDataSource
+*/
+void QCPGraph::setDataSource(const QCPGraphDataSource &source)
+{
+  mDataSource = source;
+  mUniformValues.clear();
+  mOwnedKeys.clear();
+  mFloatValues.clear();
+  mOwnedValueBoundsValid = false;
+  ++mSourceRevision;
+}
+
+/*!
+  Switches the graph to uniform keys: the graph stores only \a values, the key of the value at
+  index i is <tt>keyOffset + i*keyStep</tt>. This suits equally spaced data like FFT bins or sampled
+  signals: the memory per data point is halved and visible range and key lookups (\ref findBegin,
+  \ref findEnd) are computed instead of searched. \a keyStep must be
+  positive.
+  
+  The values are held by the graph and drawn through a \ref QCPGraphDataSource (see \ref
+  setDataSource), the data container is ignored until \ref clearDataSource is called.
+  
+  \see addUniformData, uniformKeys
+*/
+void QCPGraph::setUniformData(double keyOffset, double keyStep, const QVector<double> &values)
+{
+  if (!(keyStep > 0))
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << keyStep;
+    return;
+  }
+  mUniformValues = values;
+  mOwnedKeys.clear();
+  mFloatValues.clear();
+  mDataSource = QCPGraphDataSource(keyOffset, keyStep, mUniformValues.constData(), mUniformValues.size());
+  resetOwnedValueBounds();
+  ++mSourceRevision;
+}
+
+/*! \overload
+  
+  Stores the values in single precision, a data point takes 4 bytes. The keys are still computed
+  in double precision, so key lookups stay exact far from the key origin.
+  
+  \see floatData, setFloatData
+*/
+void QCPGraph::setUniformData(double keyOffset, double keyStep, const QVector<float> &values)
+{
+  if (!(keyStep > 0))
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << keyStep;
+    return;
+  }
+  mUniformValues.clear();
+  mOwnedKeys.clear();
+  mFloatValues = values;
+  mDataSource = QCPGraphDataSource(keyOffset, keyStep, mFloatValues.constData(), mFloatValues.size());
+  resetOwnedValueBounds();
+  ++mSourceRevision;
+}
+
+/*!
+  Replaces the data of the graph with \a keys and \a values, holding the values in single
+  precision. A data point takes 12 instead of the 16 bytes of \ref QCPGraphData, which matters for
+  traces with tens of millions of points that don't need double precision values. The keys stay
+  in double precision, so key range queries (\ref findBegin, \ref getKeyRange) and lookups of
+  time stamps remain exact.
+  
+  Like \ref setUniformData, the data is held by the graph and drawn through a \ref
+  QCPGraphDataSource, so it works with everything that uses the 1d plottable interface (\ref
+  dataCount, \ref dataMainKey, \ref findBegin, etc.). The data container is ignored until \ref
+  clearDataSource is called.
+  
+  If you can guarantee that \a keys are sorted in ascending order, set \a alreadySorted to true to
+  skip the sorting run.
+  
+  \see addFloatData, floatData
+*/
+void QCPGraph::setFloatData(const QVector<double> &keys, const QVector<float> &values, bool alreadySorted)
+{
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  const int n = qMin(keys.size(), values.size());
+  mUniformValues.clear();
+  mOwnedKeys = keys.mid(0, n);
+  mFloatValues = values.mid(0, n);
+  mDataSource = QCPGraphDataSource();
+  updateFloatSource();
+  if (!alreadySorted)
+    sortFloatData(0);
+  resetOwnedValueBounds();
+  ++mSourceRevision;
+}
+
+/*!
+  Appends \a values to the data set with \ref setUniformData, continuing its keys.
+*/
+void QCPGraph::addUniformData(const QVector<double> &values)
+{
+  if (!uniformKeys() || mDataSource.doubleValues() != mUniformValues.constData())
+  {
+    qDebug() << Q_FUNC_INFO << "graph has no uniform data, call setUniformData first";
+    return;
+  }
+  const int oldCount = mUniformValues.size();
+  mUniformValues += values;
+  mDataSource.setValues(mUniformValues.constData()); // appending may have reallocated the values
+  mDataSource.setSize(mUniformValues.size());
+  expandOwnedValueBounds(oldCount);
+  ++mSourceRevision;
+}
+
+/*! \overload
+  
+  Appends single precision \a values to the data set with the float overload of \ref
+  setUniformData.
+*/
+void QCPGraph::addUniformData(const QVector<float> &values)
+{
+  if (!uniformKeys() || !floatData())
+  {
+    qDebug() << Q_FUNC_INFO << "graph has no uniform float data, call setUniformData first";
+    return;
+  }
+  const int oldCount = mFloatValues.size();
+  mFloatValues += values;
+  updateFloatSource();
+  expandOwnedValueBounds(oldCount);
+  ++mSourceRevision;
+}
+
+/*! \overload
+  
+  If the uniform data is held in single precision, \a value is converted.
+*/
+void QCPGraph::addUniformData(double value)
+{
+  if (uniformKeys() && floatData())
+  {
+    mFloatValues.append(float(value));
+    updateFloatSource();
+    expandOwnedValueBounds(mFloatValues.size()-1);
+    ++mSourceRevision;
+    return;
+  }
+  if (!uniformKeys() || mDataSource.doubleValues() != mUniformValues.constData())
+  {
+    qDebug() << Q_FUNC_INFO << "graph has no uniform data, call setUniformData first";
+    return;
+  }
+  mUniformValues.append(value);
+  mDataSource.setValues(mUniformValues.constData());
+  mDataSource.setSize(mUniformValues.size());
+  expandOwnedValueBounds(mUniformValues.size()-1);
+  ++mSourceRevision;
+}
+
+/*!
+  Appends \a keys and \a values to the data set with \ref setFloatData. Like \ref
+  QCPDataContainer::add, only the appended points are sorted (skipped if \a alreadySorted is
+  true), and they are merged with the existing points only if the first new key is below the
+  current last one.
+*/
+void QCPGraph::addFloatData(const QVector<double> &keys, const QVector<float> &values, bool alreadySorted)
+{
+  if (uniformKeys() || !floatData())
+  {
+    qDebug() << Q_FUNC_INFO << "graph has no float data, call setFloatData first";
+    return;
+  }
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  const int n = qMin(keys.size(), values.size());
+  if (n == 0)
+    return;
+  const int oldCount = mOwnedKeys.size();
+  mOwnedKeys += keys.mid(0, n);
+  mFloatValues += values.mid(0, n);
+  expandOwnedValueBounds(oldCount);
+  if (alreadySorted && (oldCount == 0 || !(keys.first() < mOwnedKeys.at(oldCount-1))))
+    updateFloatSource();
+  else
+    sortFloatData(oldCount);
+  ++mSourceRevision;
+}
+
+/*! \overload
+*/
+void QCPGraph::addFloatData(double key, float value)
+{
+  if (uniformKeys() || !floatData())
+  {
+    qDebug() << Q_FUNC_INFO << "graph has no float data, call setFloatData first";
+    return;
+  }
+  const int oldCount = mOwnedKeys.size();
+  mOwnedKeys.append(key);
+  mFloatValues.append(value);
+  expandOwnedValueBounds(oldCount);
+  if (oldCount == 0 || !(key < mOwnedKeys.at(oldCount-1)))
+    updateFloatSource();
+  else
+    sortFloatData(oldCount);
+  ++mSourceRevision;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -21050,30 +22397,175 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
   mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
 }
 
-/*!
-  Clear Data.
-*/
-void QCPGraph::addData(double key, double value)
+/*!
+  Clear Data.
+*/
+void QCPGraph::addData(double key, double value)
+{
+  mDataContainer->add(QCPGraphData(key, value));
+}
+
+
+/*! \overload
+
+  Adds the provided points in \a keys and \a values to the current data. The provided vectors
+  should have equal length. Else, the number of added points will be the size of the smallest
+  vector.
+
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+
+  Alternatively, you can also access and modify the data directly via the \ref data method, which
+  returns a pointer to the internal data container.
+*/
+void QCPGraph::clearData()
+{
+    mDataContainer->clear();
+    if (floatData()) // float data, keep the key mapping
+    {
+        mOwnedKeys.clear();
+        mFloatValues.clear();
+        updateFloatSource();
+        resetOwnedValueBounds();
+        ++mSourceRevision;
+    } else if (uniformKeys() && mDataSource.doubleValues() == mUniformValues.constData()) // uniform data, keep the key mapping
+    {
+        mUniformValues.clear();
+        mDataSource.setValues(mUniformValues.constData());
+        mDataSource.setSize(0);
+        resetOwnedValueBounds();
+        ++mSourceRevision;
+    }
+}
+
+/*!
+  Removes the data source set with \ref setDataSource, the graph shows its data container again.
+*/
+void QCPGraph::clearDataSource()
+{
+  mDataSource = QCPGraphDataSource();
+  mUniformValues.clear();
+  mOwnedKeys.clear();
+  mFloatValues.clear();
+  mOwnedValueBoundsValid = false;
+  ++mSourceRevision;
+}
+
+/* inherits documentation from base class */
+int QCPGraph::dataCount() const
+{
+  if (hasDataSource())
+    return mDataSource.size();
+  return QCPAbstractPlottable1D<QCPGraphData>::dataCount();
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataMainKey(int index) const
+{
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainKey(index);
+  if (index >= 0 && index < mDataSource.size())
+    return mDataSource.key(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataSortKey(int index) const
+{
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::dataSortKey(index);
+  return dataMainKey(index);
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataMainValue(int index) const
+{
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainValue(index);
+  if (index >= 0 && index < mDataSource.size())
+    return mDataSource.value(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPGraph::dataValueRange(int index) const
 {
-  mDataContainer->add(QCPGraphData(key, value));
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::dataValueRange(index);
+  const double value = dataMainValue(index);
+  return QCPRange(value, value);
 }
 
+/* inherits documentation from base class */
+QPointF QCPGraph::dataPixelPosition(int index) const
+{
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::dataPixelPosition(index);
+  if (index >= 0 && index < mDataSource.size())
+    return coordsToPixels(mDataSource.key(index), mDataSource.value(index));
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return QPointF();
+}
 
-/*! \overload
-
-  Adds the provided points in \a keys and \a values to the current data. The provided vectors
-  should have equal length. Else, the number of added points will be the size of the smallest
-  vector.
+/* inherits documentation from base class */
+QCPDataSelection QCPGraph::selectTestRect(const QRectF &rect, bool onlySelectable) const
+{
+  if (!hasDataSource())
+    return QCPAbstractPlottable1D<QCPGraphData>::selectTestRect(rect, onlySelectable);
+  
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataSource.isEmpty())
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
+  
+  // convert rect given in pixels to ranges given in plot coordinates:
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  QCPRange keyRange(key1, key2); // QCPRange normalizes internally so we don't have to care about whether key1 < key2
+  QCPRange valueRange(value1, value2);
+  const int begin = mDataSource.findBegin(keyRange.lower, false);
+  const int end = mDataSource.findEnd(keyRange.upper, false);
+  
+  int currentSegmentBegin = -1; // -1 means we're currently not in a segment that's contained in rect
+  for (int i=begin; i<end; ++i)
+  {
+    const bool contained = valueRange.contains(mDataSource.value(i)) && keyRange.contains(mDataSource.key(i));
+    if (currentSegmentBegin == -1)
+    {
+      if (contained) // start segment
+        currentSegmentBegin = i;
+    } else if (!contained) // segment just ended
+    {
+      result.addDataRange(QCPDataRange(currentSegmentBegin, i), false);
+      currentSegmentBegin = -1;
+    }
+  }
+  // process potential last segment:
+  if (currentSegmentBegin != -1)
+    result.addDataRange(QCPDataRange(currentSegmentBegin, end), false);
+  
+  result.simplify();
+  return result;
+}
 
-  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
-  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+/* inherits documentation from base class */
+int QCPGraph::findBegin(double sortKey, bool expandedRange) const
+{
+  if (hasDataSource())
+    return mDataSource.findBegin(sortKey, expandedRange);
+  return QCPAbstractPlottable1D<QCPGraphData>::findBegin(sortKey, expandedRange);
+}
 
-  Alternatively, you can also access and modify the data directly via the \ref data method, which
-  returns a pointer to the internal data container.
-*/
-void QCPGraph::clearData()
+/* inherits documentation from base class */
+int QCPGraph::findEnd(double sortKey, bool expandedRange) const
 {
-    mDataContainer->clear();
+  if (hasDataSource())
+    return mDataSource.findEnd(sortKey, expandedRange);
+  return QCPAbstractPlottable1D<QCPGraphData>::findEnd(sortKey, expandedRange);
 }
 
 /*!
@@ -21086,13 +22578,21 @@ void QCPGraph::clearData()
 */
 double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+  if ((onlySelectable && mSelectable == QCP::stNone) || dataCount() == 0)
     return -1;
   if (!mKeyAxis || !mValueAxis)
     return -1;
   
   if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()) || mParentPlot->interactions().testFlag(QCP::iSelectPlottablesBeyondAxisRect))
   {
+    if (hasDataSource())
+    {
+      int pointIndex = mDataSource.size();
+      double result = sourcePointDistance(pos, pointIndex);
+      if (details)
+        details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
+      return result;
+    }
     QCPGraphDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
     double result = pointDistance(pos, closestDataPoint);
     if (details)
@@ -21108,12 +22608,23 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (hasDataSource())
+    return mDataSource.keyRange(foundRange, inSignDomain);
   return mDataContainer->keyRange(foundRange, inSignDomain);
 }
 
 /* inherits documentation from base class */
 QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (hasDataSource())
+  {
+    if (inKeyRange == QCPRange() && mOwnedValueBoundsValid && hasOwnedValues()) // values held by the graph, answered from the cached bounds
+    {
+      foundRange = mOwnedValueBounds.haveLower[inSignDomain] && mOwnedValueBounds.haveUpper[inSignDomain];
+      return mOwnedValueBounds.range[inSignDomain];
+    }
+    return mDataSource.valueRange(foundRange, inSignDomain, inKeyRange);
+  }
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
@@ -21121,26 +22632,49 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
 void QCPGraph::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
+  // progressive rendering (QCustomPlot::setProgressiveRendering), exports are always drawn in full:
+  bool preview = false;
+  if (mParentPlot->mProgressiveRendering && !painter->modes().testFlag(QCPPainter::pmNoCaching))
+  {
+    if (mRefinement && mRefinement->ready && mParentPlot->mComposingRefinement && refinementMatchesView())
+    {
+      painter->setAntialiasing(false); // no half pixel shift, the image is already rasterized
+      painter->drawImage(QPointF(0, 0), mRefinement->image);
+      return;
+    }
+    preview = progressivePreview();
+    if (preview)
+      startRefinement();
+    else
+      cancelRefinement();
+  }
+  
   QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
   
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
+  const bool geometryReady = mGeometryReady && mGeometrySegments == allSegments; // geometry computed in parallel by QCustomPlot::prepareGraphGeometry
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
     // get line pixel points appropriate to line style:
     QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
-    getLines(&lines, lineDataRange);
+    if (geometryReady)
+      lines.swap(mGeometryLines[i]);
+    else if (preview)
+      getPreviewLines(&lines, lineDataRange);
+    else
+      getLines(&lines, lineDataRange);
     
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
     QCPGraphDataContainer::const_iterator it;
-    for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
+    for (it = mDataContainer->constBegin(); !hasDataSource() && it != mDataContainer->constEnd(); ++it)
     {
       if (QCP::isInvalidData(it->key, it->value))
         qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "invalid." << "Plottable name:" << name();
@@ -21175,16 +22709,315 @@ void QCPGraph::draw(QCPPainter *painter)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
     if (!finalScatterStyle.isNone())
     {
-      getScatters(&scatters, allSegments.at(i));
+      if (geometryReady)
+        scatters.swap(mGeometryScatters[i]);
+      else if (preview)
+        getPreviewScatters(&scatters, allSegments.at(i));
+      else
+        getScatters(&scatters, allSegments.at(i));
       drawScatterPlot(painter, scatters, finalScatterStyle);
     }
   }
+  releaseGeometry();
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
   if (mSelectionDecorator)
     mSelectionDecorator->drawDecoration(painter, selection());
 }
 
+/*! \internal
+
+  First step of the parallel geometry of \ref QCP::phParallelGeometry, called on the GUI thread.
+  Stores the data segments and whether scatters are needed for them, as \ref draw determines
+  them. Returns false if the graph draws nothing.
+
+  \see computeGeometry, releaseGeometry
+*/
+bool QCPGraph::prepareGeometry()
+{
+  releaseGeometry();
+  if (!mKeyAxis || !mValueAxis) return false;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return false;
+  if (mLineStyle == lsNone && mScatterStyle.isNone()) return false;
+  
+  QList<QCPDataRange> selectedSegments, unselectedSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  mGeometrySegments << unselectedSegments << selectedSegments;
+  mGeometryUnselectedCount = unselectedSegments.size();
+  // the scatter styles are resolved here, copying them on a worker thread would copy their pixmap:
+  mGeometryUnselectedScatters = !mScatterStyle.isNone();
+  mGeometrySelectedScatters = mSelectionDecorator ? !mSelectionDecorator->getFinalScatterStyle(mScatterStyle).isNone() : mGeometryUnselectedScatters;
+  return true;
+}
+
+/*! \internal
+
+  Second step of the parallel geometry, may run on any thread: generates the line and scatter
+  pixel points of the segments stored by \ref prepareGeometry, with the same data ranges as \ref
+  draw. Only const members are read, apart from the envelope which belongs to this graph alone.
+*/
+void QCPGraph::computeGeometry()
+{
+  const int segmentCount = mGeometrySegments.size();
+  mGeometryLines.resize(segmentCount);
+  mGeometryScatters.resize(segmentCount);
+  for (int i=0; i<segmentCount; ++i)
+  {
+    bool isSelectedSegment = i >= mGeometryUnselectedCount;
+    QCPDataRange lineDataRange = isSelectedSegment ? mGeometrySegments.at(i) : mGeometrySegments.at(i).adjusted(-1, 1);
+    getLines(&mGeometryLines[i], lineDataRange);
+    if (isSelectedSegment ? mGeometrySelectedScatters : mGeometryUnselectedScatters)
+      getScatters(&mGeometryScatters[i], mGeometrySegments.at(i));
+  }
+  mGeometryReady = true;
+}
+
+/*! \internal
+
+  Discards the geometry of \ref computeGeometry, the next \ref draw computes it itself.
+*/
+void QCPGraph::releaseGeometry()
+{
+  mGeometryReady = false;
+  mGeometrySegments.clear();
+  mGeometryLines.clear();
+  mGeometryScatters.clear();
+}
+
+/*! \internal
+
+  Returns whether \ref draw shows a preview of this graph, that is when progressive rendering is
+  enabled (\ref QCustomPlot::setProgressiveRendering) and more data points are visible than \ref
+  QCustomPlot::setProgressivePreviewSize.
+*/
+bool QCPGraph::progressivePreview() const
+{
+  if (!mParentPlot->mProgressiveRendering) return false;
+  const QCPRange keyRange = mKeyAxis.data()->range();
+  return findEnd(keyRange.upper)-findBegin(keyRange.lower) > mParentPlot->mProgressivePreviewSize;
+}
+
+/*! \internal
+
+  Called by \ref draw after drawing a preview: (re)starts the refinement of this graph into an
+  image of the size of the paint buffers, for the current view, and registers it with the parent
+  plot which advances it in time slices (\ref refine).
+
+  \see cancelRefinement
+*/
+void QCPGraph::startRefinement()
+{
+  if (!mRefinement)
+    mRefinement = new QCPGraphRefinement;
+  const double ratio = mParentPlot->bufferDevicePixelRatio();
+  const QSize imageSize = mParentPlot->viewport().size()*ratio;
+  if (mRefinement->image.size() != imageSize)
+    mRefinement->image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+  mRefinement->image.setDevicePixelRatio(ratio);
+#endif
+  mRefinement->image.fill(Qt::transparent);
+  mRefinement->keyRange = mKeyAxis.data()->range();
+  mRefinement->valueRange = mValueAxis.data()->range();
+  mRefinement->clipRect = clipRect().translated(0, -1);
+  mRefinement->dataCount = dataCount();
+  mRefinement->container = mDataContainer.data();
+  mRefinement->containerRevision = mDataContainer->revision();
+  mRefinement->frontIndex = mDataContainer->frontIndex();
+  mRefinement->source = mDataSource;
+  mRefinement->sourceRevision = mSourceRevision;
+  QList<QCPDataRange> selectedSegments, unselectedSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  mRefinement->segments.clear();
+  mRefinement->segments << unselectedSegments << selectedSegments;
+  mRefinement->unselectedCount = unselectedSegments.size();
+  mRefinement->segment = 0;
+  mRefinement->stage = 0;
+  mRefinement->index = 0;
+  mRefinement->begin = 0;
+  mRefinement->end = 0;
+  mRefinement->lines.clear();
+  mRefinement->scatters.clear();
+  mRefinement->ready = false;
+  mParentPlot->registerRefinement(this);
+}
+
+/*! \internal
+
+  Continues the refinement started by \ref startRefinement until \a timer has run for \a
+  timeSlice milliseconds. The segments are drawn like in \ref draw, in units of line sampling
+  chunks, fill, line drawing chunks, scatter sampling chunks and scatter drawing chunks, so a time
+  slice is exceeded by at most one unit. Returns true once the image is complete.
+*/
+bool QCPGraph::refine(const QElapsedTimer &timer, int timeSlice)
+{
+  const int chunkSize = 4096; // line and scatter points per drawing unit
+  const int sampleChunkSize = 65536; // data points per sampling unit
+  QCPGraphRefinement *r = mRefinement;
+  if (r->ready) return true;
+  
+  QCPPainter painter(&r->image);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  painter.setRenderHint(QPainter::HighQualityAntialiasing);
+#endif
+  painter.setClipRect(r->clipRect);
+  applyDefaultAntialiasingHint(&painter);
+  const bool keyReversed = mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical); // getLines sorts by key pixel, so are the chunks
+  while (r->segment < r->segments.size())
+  {
+    if (timer.hasExpired(timeSlice))
+      return false;
+    
+    const bool isSelectedSegment = r->segment >= r->unselectedCount;
+    const QCPDataRange segment = r->segments.at(r->segment);
+    switch (r->stage)
+    {
+      case 0: // visible data points of the segment
+      {
+        getVisibleDataIndexes(r->begin, r->end, isSelectedSegment ? segment : segment.adjusted(-1, 1));
+        r->index = keyReversed ? r->end : r->begin;
+        r->lines.clear();
+        r->stage = 1;
+        break;
+      }
+      case 1: // line sampling chunks, overlapping by one data point so lines and steps stay connected, impulses don't need that
+      {
+        if (mLineStyle == lsNone || (keyReversed ? r->index <= r->begin : r->index >= r->end))
+        {
+          r->stage = 2;
+          break;
+        }
+        const int overlap = mLineStyle == lsImpulse ? 0 : 1;
+        const QCPDataRange chunk = keyReversed ? QCPDataRange(qMax(r->begin, r->index-sampleChunkSize), r->index) : QCPDataRange(r->index, qMin(r->end, r->index+sampleChunkSize));
+        QVector<QPointF> chunkLines;
+        getLines(&chunkLines, chunk);
+        r->lines += chunkLines;
+        if (keyReversed)
+          r->index = chunk.begin() > r->begin ? chunk.begin()+overlap : r->begin;
+        else
+          r->index = chunk.end() < r->end ? chunk.end()-overlap : r->end;
+        break;
+      }
+      case 2: // fill
+      {
+        if (isSelectedSegment && mSelectionDecorator)
+          mSelectionDecorator->applyBrush(&painter);
+        else
+          painter.setBrush(mBrush);
+        painter.setPen(Qt::NoPen);
+        drawFill(&painter, &r->lines);
+        r->index = 0;
+        r->stage = 3;
+        break;
+      }
+      case 3: // line drawing chunks, polylines overlap by one point, impulses are kept in pairs
+      {
+        if (mLineStyle == lsNone || r->index >= r->lines.size()-1)
+        {
+          r->lines.clear();
+          r->stage = 4;
+          break;
+        }
+        if (isSelectedSegment && mSelectionDecorator)
+          mSelectionDecorator->applyPen(&painter);
+        else
+          painter.setPen(mPen);
+        painter.setBrush(Qt::NoBrush);
+        const QVector<QPointF> chunk = r->lines.mid(r->index, chunkSize);
+        if (mLineStyle == lsImpulse)
+        {
+          drawImpulsePlot(&painter, chunk);
+          r->index += chunkSize;
+        } else
+        {
+          drawLinePlot(&painter, chunk);
+          r->index += chunkSize-1;
+        }
+        break;
+      }
+      case 4: // visible data points of the segment for scatters
+      {
+        const QCPScatterStyle finalScatterStyle = isSelectedSegment && mSelectionDecorator ? mSelectionDecorator->getFinalScatterStyle(mScatterStyle) : mScatterStyle;
+        if (finalScatterStyle.isNone())
+          r->begin = r->end = 0;
+        else
+          getVisibleDataIndexes(r->begin, r->end, segment);
+        r->index = r->begin;
+        r->scatters.clear();
+        r->stage = 5;
+        break;
+      }
+      case 5: // scatter sampling chunks, scatter skipping is aligned to the data index and not disturbed by the chunks
+      {
+        if (r->index >= r->end)
+        {
+          r->index = 0;
+          r->stage = 6;
+          break;
+        }
+        const QCPDataRange chunk(r->index, qMin(r->end, r->index+sampleChunkSize));
+        QVector<QPointF> chunkScatters;
+        getScatters(&chunkScatters, chunk);
+        r->scatters += chunkScatters;
+        r->index = chunk.end();
+        break;
+      }
+      case 6: // scatter drawing chunks
+      {
+        if (r->index >= r->scatters.size())
+        {
+          r->scatters.clear();
+          r->stage = 0;
+          ++r->segment;
+          break;
+        }
+        const QCPScatterStyle finalScatterStyle = isSelectedSegment && mSelectionDecorator ? mSelectionDecorator->getFinalScatterStyle(mScatterStyle) : mScatterStyle;
+        drawScatterPlot(&painter, r->scatters.mid(r->index, chunkSize), finalScatterStyle);
+        r->index += chunkSize;
+        break;
+      }
+    }
+  }
+  
+  // draw other selection decoration that isn't just line/scatter pens and brushes:
+  if (mSelectionDecorator)
+    mSelectionDecorator->drawDecoration(&painter, selection());
+  r->ready = true;
+  return true;
+}
+
+/*! \internal
+
+  Returns whether the refinement of this graph was started for the current axis ranges, axis rect,
+  data and paint buffer size. The data matches if the data count, the data container with its
+  revision and front index, the data source and the data held by the graph (\ref setUniformData,
+  \ref setFloatData) are unchanged, so data replaced in place or behind the view is detected too.
+*/
+bool QCPGraph::refinementMatchesView() const
+{
+  if (!mRefinement || !mKeyAxis || !mValueAxis) return false;
+  return mRefinement->keyRange == mKeyAxis.data()->range() &&
+         mRefinement->valueRange == mValueAxis.data()->range() &&
+         mRefinement->clipRect == clipRect().translated(0, -1) &&
+         mRefinement->dataCount == dataCount() &&
+         mRefinement->container == mDataContainer.data() &&
+         mRefinement->containerRevision == mDataContainer->revision() &&
+         mRefinement->frontIndex == mDataContainer->frontIndex() &&
+         qcpSameSource(mRefinement->source, mDataSource) &&
+         mRefinement->sourceRevision == mSourceRevision &&
+         mRefinement->image.size() == mParentPlot->viewport().size()*mParentPlot->bufferDevicePixelRatio();
+}
+
+/*! \internal
+
+  Drops the refinement of this graph, if any.
+*/
+void QCPGraph::cancelRefinement()
+{
+  delete mRefinement;
+  mRefinement = nullptr;
+}
+
 /* inherits documentation from base class */
 void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
@@ -21243,21 +23076,44 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
 {
   if (!lines) return;
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> lineData;
+  if (hasDataSource())
   {
-    lines->clear();
-    return;
+    int begin, end;
+    getSourceVisibleBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getSourceLineData(&lineData, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getOptimizedLineData(&lineData, begin, end);
   }
   
-  QVector<QCPGraphData> lineData;
-  if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
-  
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData (significantly simplifies following processing)
     std::reverse(lineData.begin(), lineData.end());
 
+  linesFromData(lines, lineData);
+}
+
+/*! \internal
+
+  Converts \a lineData, sorted ascending by key pixel, to the pixel points of the line style of
+  the graph. Used by \ref getLines and \ref getPreviewLines.
+*/
+void QCPGraph::linesFromData(QVector<QPointF> *lines, const QVector<QCPGraphData> &lineData) const
+{
   switch (mLineStyle)
   {
     case lsNone: lines->clear(); break;
@@ -21288,20 +23144,45 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
   
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> data;
+  if (hasDataSource())
   {
-    scatters->clear();
-    return;
+    int begin, end;
+    getSourceVisibleBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getSourceScatterData(&data, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getOptimizedScatterData(&data, begin, end);
   }
   
-  QVector<QCPGraphData> data;
-  getOptimizedScatterData(&data, begin, end);
-  
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
     std::reverse(data.begin(), data.end());
   
+  scattersFromData(scatters, data);
+}
+
+/*! \internal
+
+  Converts the data points \a data to scatter pixel coordinates in \a scatters. Points with NaN
+  values stay at the origin, like in \ref getScatters. Used by \ref getScatters and \ref
+  getPreviewScatters.
+*/
+void QCPGraph::scattersFromData(QVector<QPointF> *scatters, const QVector<QCPGraphData> &data) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
   scatters->resize(data.size());
   if (keyAxis->orientation() == Qt::Vertical)
   {
@@ -21326,6 +23207,90 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   }
 }
 
+/*! \internal
+
+  Returns via \a data about \a maxCount visible data points of \a dataRange. This is the data of
+  the preview drawn with progressive rendering (\ref QCustomPlot::setProgressiveRendering), it is
+  fast to gather regardless of the data size.
+  
+  With envelope sampling (\ref setEnvelopeSampling), the data points are decimated in buckets of
+  consecutive data points. Each bucket contributes its first and last data point and its value
+  range from the envelope, so the preview keeps the peaks of the full graph instead of aliasing,
+  at a cost that depends on \a maxCount only. Otherwise, the data points are picked evenly by
+  index, and the last visible data point is always included.
+
+  \see getPreviewLines, getPreviewScatters
+*/
+void QCPGraph::getPreviewData(QVector<QCPGraphData> *data, const QCPDataRange &dataRange, int maxCount) const
+{
+  data->clear();
+  if (hasDataSource())
+  {
+    int begin, end;
+    getSourceVisibleBounds(begin, end, dataRange);
+    if (begin == end) return;
+    const qint64 count = end-begin;
+    const qint64 stride = qMax(qint64(1), (count+maxCount-1)/maxCount);
+    data->reserve(int(count/stride)+2);
+    for (qint64 i=begin; i<end; i+=stride)
+      data->append(QCPGraphData(mDataSource.key(int(i)), mDataSource.value(int(i))));
+    if ((count-1)%stride != 0)
+      data->append(QCPGraphData(mDataSource.key(end-1), mDataSource.value(end-1)));
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end) return;
+    if (mEnvelope) // value ranges of the buckets from the envelope
+    {
+      mEnvelope->update(mDataContainer.data());
+      QCPPreviewSampler sampler;
+      sampler.begin = 0;
+      sampler.end = int(end-begin);
+      sampler.stride = qcpPreviewStride(sampler.end, maxCount);
+      sampler.data = data;
+      data->reserve(4*((sampler.end+sampler.stride-1)/sampler.stride));
+      sampler(QCPContainerKeys(begin), QCPEnvelopeValues(begin, mEnvelope, mDataContainer.data()));
+      return;
+    }
+    const qint64 count = end-begin;
+    const qint64 stride = qMax(qint64(1), (count+maxCount-1)/maxCount);
+    data->reserve(int(count/stride)+2);
+    for (qint64 i=0; i<count; i+=stride)
+      data->append(*(begin+int(i)));
+    if ((count-1)%stride != 0)
+      data->append(*(end-1));
+  }
+}
+
+/*! \internal
+
+  Same as \ref getLines for the preview data of \ref getPreviewData.
+*/
+void QCPGraph::getPreviewLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
+{
+  if (!lines) return;
+  QVector<QCPGraphData> lineData;
+  getPreviewData(&lineData, dataRange, mParentPlot->mProgressivePreviewSize);
+  if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData
+    std::reverse(lineData.begin(), lineData.end());
+  linesFromData(lines, lineData);
+}
+
+/*! \internal
+
+  Same as \ref getScatters for the preview data of \ref getPreviewData.
+*/
+void QCPGraph::getPreviewScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const
+{
+  if (!scatters) return;
+  QVector<QCPGraphData> data;
+  getPreviewData(&data, dataRange, mParentPlot->mProgressivePreviewSize);
+  if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data
+    std::reverse(data.begin(), data.end());
+  scattersFromData(scatters, data);
+}
+
 /*! \internal
 
   Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
@@ -21691,60 +23656,18 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
-    {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-      {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      ++it;
-    }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+    QCPLineSampler sampler;
+    sampler.keyAxis = keyAxis;
+    sampler.adaptive = true;
+    sampler.begin = 0;
+    sampler.end = dataCount;
+    sampler.lineData = lineData;
+    if (mEnvelope) // value ranges of the pixel columns from the envelope, the cost depends on the number of pixel columns only
     {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+      mEnvelope->update(mDataContainer.data());
+      sampler(QCPContainerKeys(begin), QCPEnvelopeValues(begin, mEnvelope, mDataContainer.data()));
     } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-    
+      sampler(QCPContainerKeys(begin), QCPContainerValues(begin));
   } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
   {
     lineData->resize(dataCount);
@@ -21771,169 +23694,28 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
+  // indices count from the container begin, so the skipped scatters don't depend on the visible range:
+  const QCPGraphDataContainer::const_iterator base = mDataContainer->constBegin();
   const int scatterModulo = mScatterSkip+1;
-  const bool doScatterSkip = mScatterSkip > 0;
-  int beginIndex = int(begin-mDataContainer->constBegin());
-  int endIndex = int(end-mDataContainer->constBegin());
-  while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
-  {
-    ++beginIndex;
-    ++begin;
-  }
-  if (begin == end) return;
-  int dataCount = int(end-begin);
-  int maxCount = (std::numeric_limits<int>::max)();
-  if (mAdaptiveSampling)
-  {
-    int keyPixelSpan = int(qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key)));
-    maxCount = 2*keyPixelSpan+2;
-  }
+  int beginIndex = int(begin-base);
+  const int endIndex = int(end-base);
+  beginIndex = (beginIndex+scatterModulo-1)/scatterModulo*scatterModulo; // advance begin to first non-skipped scatter
+  if (beginIndex >= endIndex) return;
   
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
-  {
-    double valueMaxRange = valueAxis->range().upper;
-    double valueMinRange = valueAxis->range().lower;
-    QCPGraphDataContainer::const_iterator it = begin;
-    int itIndex = int(beginIndex);
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator minValueIt = it;
-    QCPGraphDataContainer::const_iterator maxValueIt = it;
-    QCPGraphDataContainer::const_iterator currentIntervalStart = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    // advance iterator to second (non-skipped) data point because adaptive sampling works in 1 point retrospect:
-    if (!doScatterSkip)
-      ++it;
-    else
-    {
-      itIndex += scatterModulo;
-      if (itIndex < endIndex) // make sure we didn't jump over end
-        it += scatterModulo;
-      else
-      {
-        it = end;
-        itIndex = endIndex;
-      }
-    }
-    // main loop over data points:
-    while (it != end)
-    {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
-      {
-        if (it->value < minValue && it->value > valueMinRange && it->value < valueMaxRange)
-        {
-          minValue = it->value;
-          minValueIt = it;
-        } else if (it->value > maxValue && it->value > valueMinRange && it->value < valueMaxRange)
-        {
-          maxValue = it->value;
-          maxValueIt = it;
-        }
-        ++intervalDataCount;
-      } else // new pixel started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
-        {
-          // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-          double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
-          int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-          QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
-          int c = 0;
-          while (intervalIt != it)
-          {
-            if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
-              scatterData->append(*intervalIt);
-            ++c;
-            if (!doScatterSkip)
-              ++intervalIt;
-            else
-              intervalIt += scatterModulo; // since we know indices of "currentIntervalStart", "intervalIt" and "it" are multiples of scatterModulo, we can't accidentally jump over "it" here
-          }
-        } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
-          scatterData->append(*currentIntervalStart);
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalStart = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      // advance to next data point:
-      if (!doScatterSkip)
-        ++it;
-      else
-      {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
-      }
-    }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
-    {
-      // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-      double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
-      int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-      QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
-      int intervalItIndex = int(intervalIt-mDataContainer->constBegin());
-      int c = 0;
-      while (intervalIt != it)
-      {
-        if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
-          scatterData->append(*intervalIt);
-        ++c;
-        if (!doScatterSkip)
-          ++intervalIt;
-        else // here we can't guarantee that adding scatterModulo doesn't exceed "it" (because "it" is equal to "end" here, and "end" isn't scatterModulo-aligned), so check via index comparison:
-        {
-          intervalItIndex += scatterModulo;
-          if (intervalItIndex < itIndex)
-            intervalIt += scatterModulo;
-          else
-          {
-            intervalIt = it;
-            intervalItIndex = itIndex;
-          }
-        }
-      }
-    } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
-      scatterData->append(*currentIntervalStart);
-    
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  QCPScatterSampler sampler;
+  sampler.keyAxis = keyAxis;
+  sampler.valueAxis = valueAxis;
+  sampler.adaptive = false;
+  sampler.begin = beginIndex;
+  sampler.end = endIndex;
+  sampler.scatterModulo = scatterModulo;
+  sampler.scatterData = scatterData;
+  if (mAdaptiveSampling) // use adaptive sampling only if there are at least two points per pixel on average
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    int itIndex = beginIndex;
-    scatterData->reserve(dataCount);
-    while (it != end)
-    {
-      scatterData->append(*it);
-      // advance to next data point:
-      if (!doScatterSkip)
-        ++it;
-      else
-      {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex)
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
-      }
-    }
+    int keyPixelSpan = int(qAbs(keyAxis->coordToPixel((base+beginIndex)->key)-keyAxis->coordToPixel((end-1)->key)));
+    sampler.adaptive = endIndex-beginIndex >= 2*keyPixelSpan+2;
   }
+  sampler(QCPContainerKeys(base), QCPContainerValues(base));
 }
 
 /*!
@@ -21964,6 +23746,106 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
   }
 }
 
+/*! \internal
+
+  Returns the visible data points of \a rangeRestriction like \ref getVisibleDataBounds, as indices
+  into the data container or the data source. Used by \ref refine to sample the visible data points
+  in chunks.
+*/
+void QCPGraph::getVisibleDataIndexes(int &begin, int &end, const QCPDataRange &rangeRestriction) const
+{
+  if (hasDataSource())
+  {
+    getSourceVisibleBounds(begin, end, rangeRestriction);
+    return;
+  }
+  QCPGraphDataContainer::const_iterator itBegin, itEnd;
+  getVisibleDataBounds(itBegin, itEnd, rangeRestriction);
+  begin = int(itBegin-mDataContainer->constBegin());
+  end = int(itEnd-mDataContainer->constBegin());
+}
+
+/*! \internal
+
+  Same as \ref getVisibleDataBounds for the data source (\ref setDataSource), \a begin and \a end
+  are indices.
+*/
+void QCPGraph::getSourceVisibleBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const
+{
+  begin = end = mDataSource.size();
+  if (rangeRestriction.isEmpty())
+    return;
+  
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  // get visible data range, limited to rangeRestriction:
+  QCPDataRange visibleRange(mDataSource.findBegin(keyAxis->range().lower), mDataSource.findEnd(keyAxis->range().upper));
+  visibleRange = visibleRange.bounded(rangeRestriction.bounded(QCPDataRange(0, mDataSource.size()))); // this also ensures rangeRestriction outside data bounds doesn't break anything
+  begin = visibleRange.begin();
+  end = visibleRange.end();
+}
+
+/*! \internal
+
+  Same as \ref getOptimizedLineData for the data points \a begin to \a end of the data source
+  (\ref setDataSource). The arrays are read directly, per pixel column the data points are
+  located by binary search, or computed for uniform keys.
+*/
+void QCPGraph::getSourceLineData(QVector<QCPGraphData> *lineData, int begin, int end) const
+{
+  if (!lineData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (begin == end) return;
+  
+  QCPLineSampler sampler;
+  sampler.keyAxis = keyAxis;
+  sampler.adaptive = false;
+  sampler.begin = begin;
+  sampler.end = end;
+  sampler.lineData = lineData;
+  if (mAdaptiveSampling) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(mDataSource.key(begin))-keyAxis->coordToPixel(mDataSource.key(end-1)));
+    sampler.adaptive = 2*keyPixelSpan+2 < static_cast<double>((std::numeric_limits<int>::max)()) && end-begin >= int(2*keyPixelSpan+2);
+  }
+  qcpVisitSource(mDataSource, sampler);
+}
+
+/*! \internal
+
+  Same as \ref getOptimizedScatterData for the data points \a begin to \a end of the data source
+  (\ref setDataSource).
+*/
+void QCPGraph::getSourceScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const
+{
+  if (!scatterData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const int scatterModulo = mScatterSkip+1;
+  begin = (begin+scatterModulo-1)/scatterModulo*scatterModulo; // advance begin to first non-skipped scatter
+  if (begin >= end) return;
+  
+  QCPScatterSampler sampler;
+  sampler.keyAxis = keyAxis;
+  sampler.valueAxis = valueAxis;
+  sampler.adaptive = false;
+  sampler.begin = begin;
+  sampler.end = end;
+  sampler.scatterModulo = scatterModulo;
+  sampler.scatterData = scatterData;
+  if (mAdaptiveSampling) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    int keyPixelSpan = int(qAbs(keyAxis->coordToPixel(mDataSource.key(begin))-keyAxis->coordToPixel(mDataSource.key(end-1))));
+    sampler.adaptive = end-begin >= 2*keyPixelSpan+2;
+  }
+  qcpVisitSource(mDataSource, sampler);
+}
+
 /*!  \internal
   
   This method goes through the passed points in \a lineData and returns a list of the segments
@@ -22446,6 +24328,214 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   return qSqrt(minDistSqr);
 }
 
+/*! \internal
+  
+  Same as \ref pointDistance for the data source (\ref setDataSource), the index of the closest
+  data point is returned in \a closestIndex.
+*/
+double QCPGraph::sourcePointDistance(const QPointF &pixelPoint, int &closestIndex) const
+{
+  closestIndex = mDataSource.size();
+  if (mDataSource.isEmpty())
+    return -1.0;
+  if (mLineStyle == lsNone && mScatterStyle.isNone())
+    return -1.0;
+  
+  // calculate minimum distances to graph data points and find closestIndex:
+  double minDistSqr = (std::numeric_limits<double>::max)();
+  // determine which key range comes into question, taking selection tolerance around pos into account:
+  double posKeyMin, posKeyMax, dummy;
+  pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
+  pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
+  if (posKeyMin > posKeyMax)
+    qSwap(posKeyMin, posKeyMax);
+  // iterate over found data points and then choose the one with the shortest distance to pos:
+  const int end = mDataSource.findEnd(posKeyMax, true);
+  for (int i=mDataSource.findBegin(posKeyMin, true); i<end; ++i)
+  {
+    const double currentDistSqr = QCPVector2D(coordsToPixels(mDataSource.key(i), mDataSource.value(i))-pixelPoint).lengthSquared();
+    if (currentDistSqr < minDistSqr)
+    {
+      minDistSqr = currentDistSqr;
+      closestIndex = i;
+    }
+  }
+  
+  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
+  if (mLineStyle != lsNone)
+  {
+    QVector<QPointF> lineData;
+    getLines(&lineData, QCPDataRange(0, dataCount()));
+    QCPVector2D p(pixelPoint);
+    const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
+    for (int i=0; i<lineData.size()-1; i+=step)
+    {
+      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  }
+  
+  return qSqrt(minDistSqr);
+}
+
+/*! \internal
+  
+  Points the data source at the float data held by the graph, after the vectors were assigned or
+  appended to (which may have reallocated them).
+*/
+void QCPGraph::updateFloatSource()
+{
+  if (mDataSource.keyType() != QCPGraphDataSource::ktUniform)
+    mDataSource.setKeys(mOwnedKeys.constData());
+  mDataSource.setValues(mFloatValues.constData());
+  mDataSource.setSize(mFloatValues.size());
+}
+
+/*! \internal
+  
+  Sorts the float data points from index \a sortedCount on by key and merges them with the
+  points before, which must already be sorted. Like \ref QCPDataContainer::add, the sort and merge
+  are stable, so points with equal keys keep their order and existing points stay in front of
+  appended ones. Only the existing points above the first appended key are moved, so appending
+  slightly out of order costs about the number of points appended and overtaken.
+  
+  Pass 0 as \a sortedCount to sort all points.
+*/
+void QCPGraph::sortFloatData(int sortedCount)
+{
+  const int n = mOwnedKeys.size();
+  double *keys = mOwnedKeys.data();
+  float *values = mFloatValues.data();
+  
+  // sort the appended range, keys and values are separate so they are reordered via an index:
+  if (!std::is_sorted(keys+sortedCount, keys+n))
+  {
+    const int count = n-sortedCount;
+    QVector<int> order(count);
+    for (int i=0; i<count; ++i)
+      order[i] = sortedCount+i;
+    std::stable_sort(order.begin(), order.end(), [keys](int a, int b) { return keys[a] < keys[b]; });
+    QVector<double> sortedKeys(count);
+    QVector<float> sortedValues(count);
+    for (int i=0; i<count; ++i)
+    {
+      sortedKeys[i] = keys[order.at(i)];
+      sortedValues[i] = values[order.at(i)];
+    }
+    std::copy(sortedKeys.constBegin(), sortedKeys.constEnd(), keys+sortedCount);
+    std::copy(sortedValues.constBegin(), sortedValues.constEnd(), values+sortedCount);
+  }
+  
+  // merge the appended range with the existing points above its first key (the tail that is
+  // overtaken). The tail is moved aside, the merge writes never pass the next appended point read:
+  if (sortedCount > 0 && sortedCount < n && keys[sortedCount] < keys[sortedCount-1])
+  {
+    const int tailBegin = int(std::upper_bound(keys, keys+sortedCount, keys[sortedCount])-keys);
+    const int tailCount = sortedCount-tailBegin;
+    QVector<double> tailKeys(tailCount);
+    QVector<float> tailValues(tailCount);
+    std::copy(keys+tailBegin, keys+sortedCount, tailKeys.begin());
+    std::copy(values+tailBegin, values+sortedCount, tailValues.begin());
+    int tail = 0, appended = sortedCount, out = tailBegin;
+    while (tail < tailCount)
+    {
+      if (appended < n && keys[appended] < tailKeys.at(tail))
+      {
+        keys[out] = keys[appended];
+        values[out] = values[appended];
+        ++appended;
+      } else
+      {
+        keys[out] = tailKeys.at(tail);
+        values[out] = tailValues.at(tail);
+        ++tail;
+      }
+      ++out;
+    }
+  }
+  updateFloatSource();
+}
+
+QCPGraph::OwnedValueBounds::OwnedValueBounds()
+{
+  for (int i=0; i<3; ++i)
+  {
+    haveLower[i] = false;
+    haveUpper[i] = false;
+  }
+}
+
+/*! \internal
+  
+  Widens \a bounds by the values [\a first, \a last), with the same rules per sign domain as \ref
+  QCPGraphDataSource::valueRange.
+*/
+template <typename T>
+void QCPGraph::accumulateOwnedValueBounds(OwnedValueBounds &bounds, const T *first, const T *last)
+{
+  for (; first != last; ++first)
+  {
+    const double current = double(*first);
+    if (qIsNaN(current))
+      continue;
+    for (int domain=QCP::sdNegative; domain<=QCP::sdPositive; ++domain)
+    {
+      if ((domain == QCP::sdNegative && !(current < 0)) || (domain == QCP::sdPositive && !(current > 0)))
+        continue;
+      if (current < bounds.range[domain].lower || !bounds.haveLower[domain])
+      {
+        bounds.range[domain].lower = current;
+        bounds.haveLower[domain] = true;
+      }
+      if (current > bounds.range[domain].upper || !bounds.haveUpper[domain])
+      {
+        bounds.range[domain].upper = current;
+        bounds.haveUpper[domain] = true;
+      }
+    }
+  }
+}
+
+/*! \internal
+  
+  Returns whether the data source points at values held by the graph (\ref setUniformData, \ref
+  setFloatData), so the cached value bounds describe the drawn data.
+*/
+bool QCPGraph::hasOwnedValues() const
+{
+  return floatData() || (uniformKeys() && mDataSource.doubleValues() == mUniformValues.constData());
+}
+
+/*! \internal
+  
+  Scans the values held by the graph for their bounds per sign domain. Called when the values were
+  replaced or cleared, appends only widen the bounds (\ref expandOwnedValueBounds), so \ref
+  getValueRange over all data points doesn't touch the values.
+*/
+void QCPGraph::resetOwnedValueBounds()
+{
+  mOwnedValueBounds = OwnedValueBounds();
+  mOwnedValueBoundsValid = true;
+  expandOwnedValueBounds(0);
+}
+
+/*! \internal
+  
+  Widens the cached value bounds by the values held by the graph from index \a first on, which were
+  just appended. Only one of the value vectors is filled at a time. Does nothing if the bounds
+  aren't valid, i.e. the graph doesn't hold its values.
+*/
+void QCPGraph::expandOwnedValueBounds(int first)
+{
+  if (!mOwnedValueBoundsValid)
+    return;
+  if (!mFloatValues.isEmpty())
+    accumulateOwnedValueBounds(mOwnedValueBounds, mFloatValues.constData()+first, mFloatValues.constData()+mFloatValues.size());
+  else
+    accumulateOwnedValueBounds(mOwnedValueBounds, mUniformValues.constData()+first, mUniformValues.constData()+mUniformValues.size());
+}
+
 /*! \internal
   
   Finds the highest index of \a data, whose points y value is just below \a y. Assumes y values in
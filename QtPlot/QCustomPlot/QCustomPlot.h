@@ -99,6 +99,10 @@
 #if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
 #  include <QtCore/QElapsedTimer>
 #endif
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QAtomicInt>
 # if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
 #  include <QtCore/QTimeZone>
 #endif
@@ -262,6 +266,8 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phParallelGeometry = 0x008 ///< <tt>0x008</tt> the pixel geometry (lines and scatters) of visible graphs is computed on a thread pool before the layers are drawn.
+                                                ///<                Painting stays on the GUI thread, the result is identical to the serial path. Only used when at least two graphs are visible.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -2587,12 +2593,16 @@ public:
   QCPDataContainer();
   
   // getters:
-  int size() const { return mData.size()-mPreallocSize; }
+  int size() const { return mRingCapacity > 0 ? mRingSize : mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int ringCapacity() const { return mRingCapacity; }
+  qint64 frontIndex() const { return mFrontIndex; }
+  int revision() const { return mRevision; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setRingCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2608,10 +2618,10 @@ public:
   void sort();
   void squeeze(bool preAllocation=true, bool postAllocation=true);
   
-  const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
-  const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  const_iterator constBegin() const { return mData.constBegin()+(mRingCapacity > 0 ? mRingHead : mPreallocSize); }
+  const_iterator constEnd() const { return mRingCapacity > 0 ? mData.constBegin()+mRingHead+mRingSize : mData.constEnd(); }
+  iterator begin() { invalidateCaches(); return dataBegin(); }
+  iterator end() { invalidateCaches(); return dataEnd(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
@@ -2628,10 +2638,40 @@ protected:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  int mRingCapacity;
+  int mRingHead;
+  int mRingSize;
+  qint64 mFrontIndex;
+  int mRevision;
+  
+  // value bounds of all data points per sign domain, as returned by valueRange:
+  struct ValueBounds
+  {
+    ValueBounds();
+    QCPRange range[3]; // indexed by QCP::SignDomain
+    bool haveLower[3];
+    bool haveUpper[3];
+  };
+  ValueBounds mValueBounds;
+  bool mValueBoundsValid;
   
   // non-virtual methods:
+  iterator dataBegin() { return mData.begin()+(mRingCapacity > 0 ? mRingHead : mPreallocSize); }
+  iterator dataEnd() { return mRingCapacity > 0 ? mData.begin()+mRingHead+mRingSize : mData.end(); }
+  void invalidateCaches() { ++mRevision; mValueBoundsValid = false; }
+  template <class InputIterator>
+  static void accumulateValueBounds(ValueBounds &bounds, InputIterator first, InputIterator last);
+  template <class InputIterator>
+  void expandValueBounds(InputIterator first, InputIterator last);
+  void shrinkValueBounds(const_iterator first, const_iterator last);
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void ringAssign(const QVector<DataType> &data);
+  void ringPush(const DataType &data);
+  template <class InputIterator>
+  void ringAdd(InputIterator first, InputIterator last);
+  void ringRemove(const_iterator first, const_iterator last);
+  void syncRingMirror();
 };
 
 
@@ -2660,7 +2700,9 @@ protected:
   The data can be accessed with the provided const iterators (\ref constBegin, \ref constEnd). If
   it is necessary to alter existing data in-place, the non-const iterators can be used (\ref begin,
   \ref end). Changing data members that are not the sort key (for most data types called \a key) is
-  safe from the container's perspective.
+  safe from the container's perspective: handing out a non-const iterator counts as a change of the
+  data, see \ref qcpdatacontainer-revision "Change tracking". The iterators must therefore be
+  retrieved again after the container was read in between, e.g. by a replot.
 
   Great care must be taken however if the sort key is modified through the non-const iterators. For
   performance reasons, the iterators don't automatically cause a re-sorting upon their
@@ -2670,6 +2712,32 @@ protected:
   sort. Failing to do so can not be detected by the container efficiently and will cause both
   rendering artifacts and potential data loss.
 
+  \section qcpdatacontainer-revision Change tracking
+
+  Summaries of the data (see \ref QCPGraphEnvelope) are kept up to date incrementally with \ref
+  frontIndex, the running index of the first data point which grows when data points are removed
+  from the front, and \ref revision, which is incremented by every other change than appending at
+  the end or removing from the front. Each call of \ref begin or \ref end also increments the
+  revision, since data may be modified in place through the returned iterators.
+
+  The value bounds of all data points, as returned by \ref valueRange without a key range, are
+  cached for each sign domain. Adding data points only widens them, removing data points only
+  drops them if an extremum was among the removed points, the next full \ref valueRange then
+  scans the data again. So axis rescales and resets to the data range don't iterate large data
+  sets on every call. \ref sort, \ref begin and \ref end also drop the cached bounds, so prefer
+  \ref constBegin and \ref constEnd for read-only access.
+
+  \section qcpdatacontainer-ring Ring mode
+
+  For streaming traces, \ref setRingCapacity turns the container into a fixed-capacity circular
+  buffer: appending a point with a key greater than or equal to the last one is O(1) and, once the
+  capacity is reached, drops the oldest point. \ref removeBefore and \ref removeAfter only move the
+  window bounds. The storage holds every point twice (at slot \a i and \a i + capacity), so the
+  window is always one contiguous range and the iterators, \ref findBegin and \ref findEnd work
+  unchanged. Out-of-order adds and removals inside the window are supported but cost O(n). If data
+  is modified through the non-const iterators in ring mode, call \ref sort afterwards to
+  resynchronize the mirrored copies.
+
   Implementing one-dimensional plottables that make use of a \ref QCPDataContainer<T> is usually
   done by subclassing from \ref QCPAbstractPlottable1D "QCPAbstractPlottable1D<T>", which
   introduces an according \a mDataContainer member and some convenience methods.
@@ -2736,7 +2804,8 @@ protected:
 
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
-  description of this class.
+  description of this class. Calling this method increments the \ref revision and drops the cached
+  value bounds.
 */
 
 /*! \fn QCPDataContainer::iterator QCPDataContainer<DataType>::end() const
@@ -2745,7 +2814,8 @@ protected:
   
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
-  description of this class.
+  description of this class. Calling this method increments the \ref revision and drops the cached
+  value bounds.
 */
 
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::at(int index) const
@@ -2774,7 +2844,13 @@ template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mRingCapacity(0),
+  mRingHead(0),
+  mRingSize(0),
+  mFrontIndex(0),
+  mRevision(0),
+  mValueBoundsValid(true)
 {
 }
 
@@ -2797,6 +2873,37 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Switches the container to ring mode with room for \a capacity data points (see \ref
+  qcpdatacontainer-ring "Ring mode"), or back to the regular mode if \a capacity is 0. The newest
+  data points that fit into the new capacity are kept.
+  
+  The storage for 2 * \a capacity data points is allocated once, further adds don't reallocate.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setRingCapacity(int capacity)
+{
+  capacity = qMax(0, capacity);
+  if (capacity == mRingCapacity)
+    return;
+  
+  const QVector<DataType> window = mData.mid(int(constBegin()-mData.constBegin()), size());
+  ++mRevision;
+  mValueBoundsValid = false; // a smaller ring may drop data points
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+  mRingHead = 0;
+  mRingSize = 0;
+  mRingCapacity = capacity;
+  
+  if (mRingCapacity > 0)
+  {
+    mData = QVector<DataType>(2*mRingCapacity);
+    ringAssign(window);
+  } else
+    mData = window;
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2822,6 +2929,17 @@ void QCPDataContainer<DataType>::set(const QCPDataContainer<DataType> &data)
 template <class DataType>
 void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool alreadySorted)
 {
+  ++mRevision;
+  mValueBounds = ValueBounds();
+  mValueBoundsValid = false; // scanned on the next valueRange call
+  if (mRingCapacity > 0)
+  {
+    mRingHead = 0;
+    mRingSize = 0;
+    add(data, alreadySorted);
+    return;
+  }
+  
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
@@ -2840,6 +2958,11 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
 {
   if (data.isEmpty())
     return;
+  if (mRingCapacity > 0)
+  {
+    ringAdd(data.constBegin(), data.constEnd());
+    return;
+  }
   
   const int n = data.size();
   const int oldSize = size();
@@ -2849,14 +2972,19 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), dataBegin());
+    ++mRevision;
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), dataEnd()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+    {
+      std::inplace_merge(dataBegin(), dataEnd()-n, dataEnd(), qcpLessThanSortKey<DataType>);
+      ++mRevision;
+    }
   }
+  expandValueBounds(data.constBegin(), data.constEnd());
 }
 
 /*!
@@ -2872,6 +3000,18 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 {
   if (data.isEmpty())
     return;
+  if (mRingCapacity > 0)
+  {
+    if (alreadySorted)
+      ringAdd(data.constBegin(), data.constEnd());
+    else
+    {
+      QVector<DataType> sorted = data;
+      std::sort(sorted.begin(), sorted.end(), qcpLessThanSortKey<DataType>);
+      ringAdd(sorted.constBegin(), sorted.constEnd());
+    }
+    return;
+  }
   if (isEmpty())
   {
     set(data, alreadySorted);
@@ -2886,16 +3026,21 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), dataBegin());
+    ++mRevision;
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), dataEnd()-n);
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
-      std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
+      std::sort(dataEnd()-n, dataEnd(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+    {
+      std::inplace_merge(dataBegin(), dataEnd()-n, dataEnd(), qcpLessThanSortKey<DataType>);
+      ++mRevision;
+    }
   }
+  expandValueBounds(data.constBegin(), data.constEnd());
 }
 
 /*! \overload
@@ -2907,6 +3052,14 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 template <class DataType>
 void QCPDataContainer<DataType>::add(const DataType &data)
 {
+  if (mRingCapacity > 0)
+  {
+    if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1)))
+      ringPush(data);
+    else
+      ringAdd(&data, &data+1);
+    return;
+  }
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
     mData.append(data);
@@ -2915,12 +3068,15 @@ void QCPDataContainer<DataType>::add(const DataType &data)
     if (mPreallocSize < 1)
       preallocateGrow(1);
     --mPreallocSize;
-    *begin() = data;
+    *dataBegin() = data;
+    ++mRevision;
   } else // handle inserts, maintaining sorted keys
   {
-    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
+    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(dataBegin(), dataEnd(), data, qcpLessThanSortKey<DataType>);
     mData.insert(insertionPoint, data);
+    ++mRevision;
   }
+  expandValueBounds(&data, &data+1);
 }
 
 /*!
@@ -2931,8 +3087,16 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 template <class DataType>
 void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = begin();
-  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator it = dataBegin();
+  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  shrinkValueBounds(it, itEnd);
+  mFrontIndex += itEnd-it;
+  if (mRingCapacity > 0) // just move the start of the window
+  {
+    mRingHead = (mRingHead+int(itEnd-it)) % mRingCapacity;
+    mRingSize -= int(itEnd-it);
+    return;
+  }
   mPreallocSize += int(itEnd-it); // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2946,8 +3110,15 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = end();
+  QCPDataContainer<DataType>::iterator it = std::upper_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = dataEnd();
+  shrinkValueBounds(it, itEnd);
+  ++mRevision;
+  if (mRingCapacity > 0) // just move the end of the window
+  {
+    mRingSize -= int(itEnd-it);
+    return;
+  }
   mData.erase(it, itEnd); // typically adds it to the postallocated block
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2966,8 +3137,15 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
   if (sortKeyFrom >= sortKeyTo || isEmpty())
     return;
   
-  QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator it = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, dataEnd(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  shrinkValueBounds(it, itEnd);
+  ++mRevision;
+  if (mRingCapacity > 0)
+  {
+    ringRemove(it, itEnd);
+    return;
+  }
   mData.erase(it, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2985,10 +3163,17 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
 template <class DataType>
 void QCPDataContainer<DataType>::remove(double sortKey)
 {
-  QCPDataContainer::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  if (it != end() && it->sortKey() == sortKey)
+  QCPDataContainer::iterator it = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  if (it != dataEnd() && it->sortKey() == sortKey)
   {
-    if (it == begin())
+    shrinkValueBounds(it, it+1);
+    ++mRevision;
+    if (mRingCapacity > 0)
+    {
+      ringRemove(it, it+1);
+      return;
+    }
+    if (it == dataBegin())
       ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
     else
       mData.erase(it);
@@ -3005,6 +3190,15 @@ void QCPDataContainer<DataType>::remove(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::clear()
 {
+  ++mRevision;
+  mValueBounds = ValueBounds();
+  mValueBoundsValid = true;
+  if (mRingCapacity > 0) // keep the ring storage
+  {
+    mRingHead = 0;
+    mRingSize = 0;
+    return;
+  }
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
@@ -3024,7 +3218,11 @@ void QCPDataContainer<DataType>::clear()
 template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
-  std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  std::sort(dataBegin(), dataEnd(), qcpLessThanSortKey<DataType>);
+  ++mRevision;
+  mValueBoundsValid = false; // values may have been modified through the iterators
+  if (mRingCapacity > 0)
+    syncRingMirror();
 }
 
 /*!
@@ -3040,11 +3238,13 @@ void QCPDataContainer<DataType>::sort()
 template <class DataType>
 void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation)
 {
+  if (mRingCapacity > 0) // ring storage has a fixed size
+    return;
   if (preAllocation)
   {
     if (mPreallocSize > 0)
     {
-      std::copy(begin(), end(), mData.begin());
+      std::copy(dataBegin(), dataEnd(), mData.begin());
       mData.resize(size());
       mPreallocSize = 0;
     }
@@ -3254,8 +3454,19 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     foundRange = false;
     return QCPRange();
   }
-  QCPRange range;
   const bool restrictKeyRange = inKeyRange != QCPRange();
+  if (!restrictKeyRange) // all data points, answered from the cached bounds
+  {
+    if (!mValueBoundsValid)
+    {
+      mValueBounds = ValueBounds();
+      accumulateValueBounds(mValueBounds, constBegin(), constEnd());
+      mValueBoundsValid = true;
+    }
+    foundRange = mValueBounds.haveLower[signDomain] && mValueBounds.haveUpper[signDomain];
+    return mValueBounds.range[signDomain];
+  }
+  QCPRange range;
   bool haveLower = false;
   bool haveUpper = false;
   QCPRange current;
@@ -3404,6 +3615,202 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
 
+/*! \internal
+  
+  Replaces the ring content with the sorted \a data, keeping the newest data points if there are
+  more than the ring capacity.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::ringAssign(const QVector<DataType> &data)
+{
+  const int first = qMax(0, data.size()-mRingCapacity);
+  DataType *buffer = mData.data();
+  ++mRevision;
+  mRingHead = 0;
+  mRingSize = data.size()-first;
+  for (int i=0; i<mRingSize; ++i)
+  {
+    buffer[i] = data.at(first+i);
+    buffer[i+mRingCapacity] = buffer[i];
+  }
+}
+
+/*! \internal
+  
+  Appends \a data behind the last data point of the ring, overwriting the oldest one if the ring is
+  full. The caller makes sure the sort key of \a data isn't smaller than the last one.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::ringPush(const DataType &data)
+{
+  int slot;
+  if (mRingSize == mRingCapacity) // the oldest data point leaves at the front
+  {
+    shrinkValueBounds(constBegin(), constBegin()+1);
+    slot = mRingHead;
+    mRingHead = (mRingHead+1) % mRingCapacity;
+    ++mFrontIndex;
+  } else
+  {
+    slot = (mRingHead+mRingSize) % mRingCapacity;
+    ++mRingSize;
+  }
+  DataType *buffer = mData.data();
+  buffer[slot] = data;
+  buffer[slot+mRingCapacity] = data;
+  expandValueBounds(&data, &data+1);
+}
+
+/*! \internal
+  
+  Adds the sorted range [\a first, \a last) to the ring. Ranges starting at or after the last key
+  are pushed, everything else is merged with the current window.
+*/
+template <class DataType>
+template <class InputIterator>
+void QCPDataContainer<DataType>::ringAdd(InputIterator first, InputIterator last)
+{
+  if (first == last)
+    return;
+  
+  if (isEmpty() || !qcpLessThanSortKey<DataType>(*first, *(constEnd()-1)))
+  {
+    const int n = int(std::distance(first, last));
+    if (n > mRingCapacity) // only the newest points survive
+      std::advance(first, n-mRingCapacity);
+    for (; first != last; ++first)
+      ringPush(*first);
+  } else
+  {
+    QVector<DataType> merged;
+    merged.reserve(size()+int(std::distance(first, last)));
+    std::merge(constBegin(), constEnd(), first, last, std::back_inserter(merged), qcpLessThanSortKey<DataType>);
+    expandValueBounds(first, last);
+    shrinkValueBounds(merged.constBegin(), merged.constBegin()+qMax(0, merged.size()-mRingCapacity)); // ringAssign keeps the newest points
+    ringAssign(merged);
+  }
+}
+
+/*! \internal
+  
+  Removes the data points [\a first, \a last) of the ring window. Removals at either end of the
+  window only move its bounds.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::ringRemove(const_iterator first, const_iterator last)
+{
+  const int n = int(last-first);
+  if (n <= 0)
+    return;
+  
+  if (first == constBegin())
+  {
+    mFrontIndex += n;
+    mRingHead = (mRingHead+n) % mRingCapacity;
+    mRingSize -= n;
+  } else if (last == constEnd())
+  {
+    mRingSize -= n;
+  } else
+  {
+    QVector<DataType> kept;
+    kept.reserve(size()-n);
+    std::copy(constBegin(), first, std::back_inserter(kept));
+    std::copy(last, constEnd(), std::back_inserter(kept));
+    ringAssign(kept);
+  }
+}
+
+/*! \internal
+  
+  Copies every data point of the ring window to its mirrored slot, after the window was modified
+  in place.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::syncRingMirror()
+{
+  DataType *buffer = mData.data();
+  for (int i=mRingHead; i<mRingHead+mRingSize; ++i)
+    buffer[i < mRingCapacity ? i+mRingCapacity : i-mRingCapacity] = buffer[i];
+}
+
+template <class DataType>
+QCPDataContainer<DataType>::ValueBounds::ValueBounds()
+{
+  for (int i=0; i<3; ++i)
+  {
+    haveLower[i] = false;
+    haveUpper[i] = false;
+  }
+}
+
+/*! \internal
+  
+  Widens \a bounds by the value ranges of the data points [\a first, \a last), with the same rules
+  per sign domain as \ref valueRange.
+*/
+template <class DataType>
+template <class InputIterator>
+void QCPDataContainer<DataType>::accumulateValueBounds(ValueBounds &bounds, InputIterator first, InputIterator last)
+{
+  for (; first != last; ++first)
+  {
+    const QCPRange current = first->valueRange();
+    for (int domain=QCP::sdNegative; domain<=QCP::sdPositive; ++domain)
+    {
+      const bool lowerInDomain = domain == QCP::sdBoth || (domain == QCP::sdNegative ? current.lower < 0 : current.lower > 0);
+      const bool upperInDomain = domain == QCP::sdBoth || (domain == QCP::sdNegative ? current.upper < 0 : current.upper > 0);
+      if ((current.lower < bounds.range[domain].lower || !bounds.haveLower[domain]) && lowerInDomain && !qIsNaN(current.lower))
+      {
+        bounds.range[domain].lower = current.lower;
+        bounds.haveLower[domain] = true;
+      }
+      if ((current.upper > bounds.range[domain].upper || !bounds.haveUpper[domain]) && upperInDomain && !qIsNaN(current.upper))
+      {
+        bounds.range[domain].upper = current.upper;
+        bounds.haveUpper[domain] = true;
+      }
+    }
+  }
+}
+
+/*! \internal
+  
+  Widens the cached value bounds by the added data points [\a first, \a last). Does nothing if
+  the bounds aren't valid, they are scanned on the next \ref valueRange call anyway.
+*/
+template <class DataType>
+template <class InputIterator>
+void QCPDataContainer<DataType>::expandValueBounds(InputIterator first, InputIterator last)
+{
+  if (mValueBoundsValid)
+    accumulateValueBounds(mValueBounds, first, last);
+}
+
+/*! \internal
+  
+  Called before the data points [\a first, \a last) are removed. The cached value bounds stay
+  valid unless one of the removed points lies on a bound of any sign domain.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::shrinkValueBounds(const_iterator first, const_iterator last)
+{
+  if (!mValueBoundsValid || first == last)
+    return;
+  
+  ValueBounds removed;
+  accumulateValueBounds(removed, first, last);
+  for (int domain=QCP::sdNegative; domain<=QCP::sdPositive; ++domain)
+  {
+    if ((removed.haveLower[domain] && !(removed.range[domain].lower > mValueBounds.range[domain].lower)) ||
+        (removed.haveUpper[domain] && !(removed.range[domain].upper < mValueBounds.range[domain].upper)))
+    {
+      mValueBoundsValid = false;
+      return;
+    }
+  }
+}
+
 
 /* end of 'src/datacontainer.h' */
 
@@ -3812,6 +4219,10 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  bool progressiveRendering() const { return mProgressiveRendering; }
+  int progressiveTimeSlice() const { return mProgressiveTimeSlice; }
+  int progressivePreviewSize() const { return mProgressivePreviewSize; }
+  bool isRefining() const { return !mRefiningGraphs.isEmpty(); }
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3836,6 +4247,9 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setProgressiveRendering(bool enabled);
+  void setProgressiveTimeSlice(int msecs);
+  void setProgressivePreviewSize(int points);
   
   // non-property methods:
   // plottable interface:
@@ -3930,6 +4344,7 @@ signals:
   void beforeReplot();
   void afterLayout();
   void afterReplot();
+  void refinementFinished();
   
 protected:
   // property members:
@@ -3956,6 +4371,9 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  bool mProgressiveRendering;
+  int mProgressiveTimeSlice;
+  int mProgressivePreviewSize;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
@@ -3971,6 +4389,9 @@ protected:
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
+  QList<QPointer<QCPGraph> > mRefiningGraphs;
+  QTimer *mRefineTimer;
+  bool mComposingRefinement;
 #ifdef QCP_OPENGL_FBO
   QSharedPointer<QOpenGLContext> mGlContext;
   QSharedPointer<QSurface> mGlSurface;
@@ -3996,6 +4417,7 @@ protected:
   Q_SLOT virtual void processRectSelection(QRect rect, QMouseEvent *event);
   Q_SLOT virtual void processRectZoom(QRect rect, QMouseEvent *event);
   Q_SLOT virtual void processPointSelection(QMouseEvent *event);
+  Q_SLOT virtual void processRefinement();
   
   // non-virtual methods:
   bool registerPlottable(QCPAbstractPlottable *plottable);
@@ -4006,6 +4428,10 @@ protected:
   QList<QCPLayerable*> layerableListAt(const QPointF &pos, bool onlySelectable, QList<QVariant> *selectionDetails=nullptr) const;
   void drawBackground(QCPPainter *painter);
   void setupPaintBuffers();
+  void prepareGraphGeometry();
+  void releaseGraphGeometry();
+  void registerRefinement(QCPGraph *graph);
+  void cancelRefinements();
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
   bool setupOpenGl();
@@ -5457,6 +5883,149 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphEnvelope
+{
+public:
+  QCPGraphEnvelope();
+  
+  // non-virtual methods:
+  void clear();
+  void update(const QCPGraphDataContainer *data);
+  QCPRange valueRange(const QCPGraphDataContainer *data, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const;
+  int levelCount() const { return mLevels.size(); }
+  
+protected:
+  enum { BaseBlockSize = 16    ///< data points per block of the lowest level
+         ,LevelShift = 2       ///< each level has blocks 2^LevelShift times larger than the one below
+         ,MaxLevels = 12
+       };
+  
+  struct Level
+  {
+    qint64 firstBlock;
+    QVector<QCPRange> blocks;
+  };
+  
+  // non-property members:
+  const QCPGraphDataContainer *mData;
+  int mRevision;
+  qint64 mEnd;
+  QVector<Level> mLevels;
+  
+  // non-virtual methods:
+  static qint64 blockSize(int level) { return qint64(BaseBlockSize) << (LevelShift*level); }
+  static void expand(QCPRange &range, double value);
+  static void expand(QCPRange &range, const QCPRange &other);
+};
+
+class QCP_LIB_DECL QCPGraphDataSource
+{
+public:
+  /*!
+    Defines where the keys of the data points come from.
+    \see setKeys, setUniformKeys
+  */
+  enum KeyType { ktDouble   ///< keys are read from an array of double
+                 ,ktFloat   ///< keys are read from an array of float
+                 ,ktUniform ///< the key of data point i is <tt>keyStart + i*keyStep</tt>, no key array is needed
+               };
+  /*!
+    Defines the element type of the value array.
+    \see setValues
+  */
+  enum ValueType { vtDouble ///< values are read from an array of double
+                   ,vtFloat ///< values are read from an array of float
+                 };
+  
+  QCPGraphDataSource();
+  QCPGraphDataSource(const double *keys, const double *values, int size);
+  QCPGraphDataSource(const float *keys, const float *values, int size);
+  QCPGraphDataSource(double keyStart, double keyStep, const double *values, int size);
+  QCPGraphDataSource(double keyStart, double keyStep, const float *values, int size);
+  
+  // getters:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  bool isNull() const { return (!mDoubleValues && !mFloatValues) || (mKeyType == ktDouble && !mDoubleKeys) || (mKeyType == ktFloat && !mFloatKeys); }
+  KeyType keyType() const { return mKeyType; }
+  ValueType valueType() const { return mValueType; }
+  const double *doubleKeys() const { return mDoubleKeys; }
+  const float *floatKeys() const { return mFloatKeys; }
+  double keyStart() const { return mKeyStart; }
+  double keyStep() const { return mKeyStep; }
+  const double *doubleValues() const { return mDoubleValues; }
+  const float *floatValues() const { return mFloatValues; }
+  inline double key(int index) const;
+  inline double value(int index) const;
+  
+  // setters:
+  void setKeys(const double *keys);
+  void setKeys(const float *keys);
+  void setUniformKeys(double keyStart, double keyStep);
+  void setValues(const double *values);
+  void setValues(const float *values);
+  void setSize(int size);
+  
+  // non-property methods:
+  int findBegin(double sortKey, bool expandedRange=true) const;
+  int findEnd(double sortKey, bool expandedRange=true) const;
+  QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth) const;
+  QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const;
+  
+protected:
+  // property members:
+  KeyType mKeyType;
+  ValueType mValueType;
+  const double *mDoubleKeys;
+  const float *mFloatKeys;
+  double mKeyStart, mKeyStep;
+  const double *mDoubleValues;
+  const float *mFloatValues;
+  int mSize;
+};
+Q_DECLARE_TYPEINFO(QCPGraphDataSource, Q_MOVABLE_TYPE);
+
+/*!
+  Returns the key of the data point at \a index. \a index must be in the range 0 to \ref size-1.
+*/
+inline double QCPGraphDataSource::key(int index) const
+{
+  switch (mKeyType)
+  {
+    case ktDouble: return mDoubleKeys[index];
+    case ktFloat: return double(mFloatKeys[index]);
+    case ktUniform: break;
+  }
+  return mKeyStart+index*mKeyStep;
+}
+
+/*!
+  Returns the value of the data point at \a index. \a index must be in the range 0 to \ref size-1.
+*/
+inline double QCPGraphDataSource::value(int index) const
+{
+  return mValueType == vtFloat ? double(mFloatValues[index]) : mDoubleValues[index];
+}
+
+// state of the time-sliced refinement of a graph, see QCustomPlot::setProgressiveRendering
+struct QCPGraphRefinement
+{
+  QImage image;
+  QCPRange keyRange, valueRange;
+  QRect clipRect;
+  int dataCount;
+  const QCPGraphDataContainer *container;
+  int containerRevision;
+  qint64 frontIndex;
+  QCPGraphDataSource source;
+  int sourceRevision;
+  QList<QCPDataRange> segments;
+  int unselectedCount;
+  int segment, stage, index, begin, end;
+  QVector<QPointF> lines, scatters;
+  bool ready;
+};
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5493,6 +6062,11 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool envelopeSampling() const { return mEnvelope != nullptr; }
+  QCPGraphDataSource dataSource() const { return mDataSource; }
+  bool hasDataSource() const { return !mDataSource.isNull(); }
+  bool uniformKeys() const { return hasDataSource() && mDataSource.keyType() == QCPGraphDataSource::ktUniform; }
+  bool floatData() const { return hasDataSource() && mDataSource.valueType() == QCPGraphDataSource::vtFloat && mDataSource.floatValues() == mFloatValues.constData(); }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5502,11 +6076,33 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setEnvelopeSampling(bool enabled);
+  void setDataSource(const QCPGraphDataSource &source);
+  void setUniformData(double keyOffset, double keyStep, const QVector<double> &values);
+  void setUniformData(double keyOffset, double keyStep, const QVector<float> &values);
+  void setFloatData(const QVector<double> &keys, const QVector<float> &values, bool alreadySorted=false);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void addData(double key, double value);
   void clearData();
+  void addUniformData(const QVector<double> &values);
+  void addUniformData(const QVector<float> &values);
+  void addUniformData(double value);
+  void addFloatData(const QVector<double> &keys, const QVector<float> &values, bool alreadySorted=false);
+  void addFloatData(double key, float value);
+  void clearDataSource();
+  
+  // virtual methods of 1d plottable interface:
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
@@ -5521,6 +6117,29 @@ protected:
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  QCPGraphEnvelope *mEnvelope;
+  QCPGraphDataSource mDataSource;
+  QVector<double> mUniformValues;
+  QVector<double> mOwnedKeys;
+  QVector<float> mFloatValues;
+  // value bounds of the values held by the graph per sign domain, as returned by getValueRange:
+  struct OwnedValueBounds
+  {
+    OwnedValueBounds();
+    QCPRange range[3]; // indexed by QCP::SignDomain
+    bool haveLower[3];
+    bool haveUpper[3];
+  };
+  OwnedValueBounds mOwnedValueBounds;
+  bool mOwnedValueBoundsValid;
+  int mSourceRevision; // counts changes of the data source and the data held by the graph
+  QList<QCPDataRange> mGeometrySegments;
+  int mGeometryUnselectedCount;
+  bool mGeometryUnselectedScatters, mGeometrySelectedScatters, mGeometryReady;
+  QVector<QVector<QPointF> > mGeometryLines, mGeometryScatters;
+  QCPGraphRefinement *mRefinement;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
@@ -5536,8 +6155,17 @@ protected:
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  void getSourceVisibleBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const;
+  void getVisibleDataIndexes(int &begin, int &end, const QCPDataRange &rangeRestriction) const;
+  void getSourceLineData(QVector<QCPGraphData> *lineData, int begin, int end) const;
+  void getSourceScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
+  void getPreviewData(QVector<QCPGraphData> *data, const QCPDataRange &dataRange, int maxCount) const;
+  void getPreviewLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
+  void getPreviewScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
+  void linesFromData(QVector<QPointF> *lines, const QVector<QCPGraphData> &lineData) const;
+  void scattersFromData(QVector<QPointF> *scatters, const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepLeftLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepRightLines(const QVector<QCPGraphData> &data) const;
@@ -5554,6 +6182,22 @@ protected:
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const;
+  double sourcePointDistance(const QPointF &pixelPoint, int &closestIndex) const;
+  void updateFloatSource();
+  void sortFloatData(int sortedCount);
+  bool hasOwnedValues() const;
+  void resetOwnedValueBounds();
+  void expandOwnedValueBounds(int first);
+  template <typename T>
+  static void accumulateOwnedValueBounds(OwnedValueBounds &bounds, const T *first, const T *last);
+  bool prepareGeometry();
+  void computeGeometry();
+  void releaseGeometry();
+  bool progressivePreview() const;
+  void startRefinement();
+  bool refine(const QElapsedTimer &timer, int timeSlice);
+  bool refinementMatchesView() const;
+  void cancelRefinement();
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -4,6 +4,7 @@
 
 #define WATERFALL_LAYER_NAME	"waterfall"
 #define MARKERS_LAYER_NAME		"markers"
+#define COLOR_SCALE_LAYER_NAME	"colorscale"
 
 #ifndef BUILD_STATIC
 # if defined(QTPLOT_LIB)
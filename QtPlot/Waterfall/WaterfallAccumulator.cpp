@@ -0,0 +1,153 @@
+#include "WaterfallAccumulator.h"
+
+#include <algorithm>
+
+
+WaterfallAccumulator::WaterfallAccumulator()
+{
+}
+
+void WaterfallAccumulator::setEnabled(EWaterfallTrace trace, bool enable)
+{
+	QMutexLocker locker(&mutex);
+
+	switch (trace)
+	{
+	case EWT_MaxHold:
+		bIsMaxEnabled = enable;
+		maxHold.clear();
+		break;
+
+	case EWT_Average:
+		bIsAverageEnabled = enable;
+		average.clear();
+		break;
+
+	case EWT_MinHold:
+		bIsMinEnabled = enable;
+		minHold.clear();
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool WaterfallAccumulator::isEnabled(EWaterfallTrace trace) const
+{
+	QMutexLocker locker(&mutex);
+
+	switch (trace)
+	{
+	case EWT_MaxHold: return bIsMaxEnabled;
+	case EWT_Average: return bIsAverageEnabled;
+	case EWT_MinHold: return bIsMinEnabled;
+	default: return true;
+	}
+}
+
+void WaterfallAccumulator::setAverageFactor(double alpha)
+{
+	QMutexLocker locker(&mutex);
+	averageFactor = qBound(0.0, alpha, 1.0);
+}
+
+double WaterfallAccumulator::getAverageFactor() const
+{
+	QMutexLocker locker(&mutex);
+	return averageFactor;
+}
+
+void WaterfallAccumulator::reset()
+{
+	QMutexLocker locker(&mutex);
+
+	maxHold.clear();
+	average.clear();
+	minHold.clear();
+}
+
+const double* WaterfallAccumulator::update(const double* data, int size, EWaterfallTrace display, QVector<double>& row)
+{
+	QMutexLocker locker(&mutex);
+
+	if (bIsMaxEnabled)
+	{
+		if (maxHold.size() != size)
+		{
+			initialize(maxHold, data, size);
+		}
+		else
+		{
+			double* plane = maxHold.data();
+			for (int i = 0; i < size; i++)
+				plane[i] = data[i] > plane[i] ? data[i] : plane[i];
+		}
+	}
+
+	if (bIsAverageEnabled)
+	{
+		if (average.size() != size)
+		{
+			initialize(average, data, size);
+		}
+		else
+		{
+			const double alpha = averageFactor;
+			double* plane = average.data();
+			for (int i = 0; i < size; i++)
+				plane[i] += alpha * (data[i] - plane[i]);
+		}
+	}
+
+	if (bIsMinEnabled)
+	{
+		if (minHold.size() != size)
+		{
+			initialize(minHold, data, size);
+		}
+		else
+		{
+			double* plane = minHold.data();
+			for (int i = 0; i < size; i++)
+				plane[i] = data[i] < plane[i] ? data[i] : plane[i];
+		}
+	}
+
+	const QVector<double>* plane = nullptr;
+	switch (display)
+	{
+	case EWT_MaxHold: plane = bIsMaxEnabled ? &maxHold : nullptr; break;
+	case EWT_Average: plane = bIsAverageEnabled ? &average : nullptr; break;
+	case EWT_MinHold: plane = bIsMinEnabled ? &minHold : nullptr; break;
+	default: break;
+	}
+
+	if (plane == nullptr) return data;
+
+	//reset() and setEnabled() may free the plane as soon as the mutex is released
+	row.resize(size);
+	std::copy(plane->constData(), plane->constData() + size, row.data());
+
+	return row.constData();
+}
+
+QVector<double> WaterfallAccumulator::trace(EWaterfallTrace trace) const
+{
+	QMutexLocker locker(&mutex);
+
+	switch (trace)
+	{
+	case EWT_MaxHold: return maxHold;
+	case EWT_Average: return average;
+	case EWT_MinHold: return minHold;
+	default: return QVector<double>();
+	}
+}
+
+void WaterfallAccumulator::initialize(QVector<double>& plane, const double* data, int size)
+{
+	//first row or the row width changed - restart accumulation
+	plane.resize(size);
+	std::copy(data, data + size, plane.data());
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QMutex>
+#include <QVector>
+
+#include "Library/QtPlotEnumLibrary.h"
+
+
+/*!
+\brief Persistence planes of the waterfall
+
+Running max, exponential average and min of every appended row.
+Planes are updated incrementally in the ingest thread, traces can be read from any thread.
+*/
+class WaterfallAccumulator
+{
+public:
+	WaterfallAccumulator();
+
+	void setEnabled(EWaterfallTrace trace, bool enable);
+	bool isEnabled(EWaterfallTrace trace) const;
+
+	void setAverageFactor(double alpha);
+	double getAverageFactor() const;
+
+	void reset();
+
+	/*!
+	\brief Update enabled planes with a new row
+
+	\param data Array of double values. Size: size.
+	\param size Width of the row.
+	\param display Plane which should be returned.
+	\param row Receives a copy of the 'display' plane, made while the planes are locked.
+	\return 'row' with the 'display' plane, 'data' for EWT_Raw or a disabled plane.
+	*/
+	const double* update(const double* data, int size, EWaterfallTrace display, QVector<double>& row);
+
+	QVector<double> trace(EWaterfallTrace trace) const;
+
+private:
+	static void initialize(QVector<double>& plane, const double* data, int size);
+
+private:
+	mutable QMutex	mutex;
+
+	QVector<double>	maxHold;
+	QVector<double>	average;
+	QVector<double>	minHold;
+
+	bool	bIsMaxEnabled = false;
+	bool	bIsAverageEnabled = false;
+	bool	bIsMinEnabled = false;
+
+	double	averageFactor = 0.1;
+
+};
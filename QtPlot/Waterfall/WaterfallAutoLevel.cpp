@@ -0,0 +1,268 @@
+#include "WaterfallAutoLevel.h"
+
+#include <qnumeric.h>
+#include <algorithm>
+#include <limits>
+
+
+WaterfallQuantile::WaterfallQuantile(double p)
+{
+	reset(p);
+}
+
+void WaterfallQuantile::reset(double p)
+{
+	probability = qBound(0.0, p, 1.0);
+	samples = 0;
+
+	for (int i = 0; i < 5; i++)
+	{
+		heights[i] = 0.0;
+		positions[i] = i;
+	}
+
+	desired[0] = 0.0;
+	desired[1] = 2.0 * probability;
+	desired[2] = 4.0 * probability;
+	desired[3] = 2.0 + 2.0 * probability;
+	desired[4] = 4.0;
+
+	increments[0] = 0.0;
+	increments[1] = probability / 2.0;
+	increments[2] = probability;
+	increments[3] = (1.0 + probability) / 2.0;
+	increments[4] = 1.0;
+}
+
+void WaterfallQuantile::add(double x)
+{
+	if (samples < 5)
+	{
+		heights[samples++] = x;
+		if (samples == 5)
+		{
+			std::sort(heights, heights + 5);
+		}
+		return;
+	}
+
+	int k;
+	if (x < heights[0])
+	{
+		heights[0] = x;
+		k = 0;
+	}
+	else if (x >= heights[4])
+	{
+		heights[4] = x;
+		k = 3;
+	}
+	else
+	{
+		k = 0;
+		while (x >= heights[k + 1]) k++;
+	}
+
+	for (int i = k + 1; i < 5; i++)
+	{
+		positions[i] += 1.0;
+	}
+
+	for (int i = 0; i < 5; i++)
+	{
+		desired[i] += increments[i];
+	}
+
+	//adjust the middle markers
+	for (int i = 1; i < 4; i++)
+	{
+		const double d = desired[i] - positions[i];
+
+		if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0)
+			|| (d <= -1.0 && positions[i - 1] - positions[i] < -1.0))
+		{
+			const int sign = d > 0.0 ? 1 : -1;
+
+			const double height = parabolic(i, sign);
+			if (heights[i - 1] < height && height < heights[i + 1])
+			{
+				heights[i] = height;
+			}
+			else
+			{
+				heights[i] = linear(i, sign);
+			}
+
+			positions[i] += sign;
+		}
+	}
+
+	samples++;
+}
+
+double WaterfallQuantile::value() const
+{
+	if (samples == 0) return 0.0;
+
+	if (samples < 5)
+	{
+		double sorted[5];
+		std::copy(heights, heights + samples, sorted);
+		std::sort(sorted, sorted + samples);
+
+		return sorted[static_cast<int>(probability * (samples - 1) + 0.5)];
+	}
+
+	return heights[2];
+}
+
+double WaterfallQuantile::parabolic(int i, double d) const
+{
+	return heights[i] + d / (positions[i + 1] - positions[i - 1])
+		* ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i])
+			+ (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+}
+
+double WaterfallQuantile::linear(int i, int d) const
+{
+	return heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+}
+
+
+WaterfallAutoLevel::WaterfallAutoLevel()
+	: lowQuantile(0.05),
+	highQuantile(0.99)
+{
+}
+
+void WaterfallAutoLevel::setEnabled(bool enable)
+{
+	QMutexLocker locker(&mutex);
+
+	bIsEnabled = enable;
+
+	rows = 0;
+	lowQuantile.reset(lowPercentile);
+	highQuantile.reset(highPercentile);
+	updateTimer.invalidate();
+}
+
+bool WaterfallAutoLevel::isEnabled() const
+{
+	QMutexLocker locker(&mutex);
+	return bIsEnabled;
+}
+
+void WaterfallAutoLevel::setPercentiles(double low, double high)
+{
+	QMutexLocker locker(&mutex);
+
+	lowPercentile = qBound(0.0, qMin(low, high), 1.0);
+	highPercentile = qBound(0.0, qMax(low, high), 1.0);
+
+	rows = 0;
+	lowQuantile.reset(lowPercentile);
+	highQuantile.reset(highPercentile);
+}
+
+void WaterfallAutoLevel::setWindow(int inRows)
+{
+	QMutexLocker locker(&mutex);
+	window = qMax(1, inRows);
+}
+
+void WaterfallAutoLevel::setHysteresis(double fraction)
+{
+	QMutexLocker locker(&mutex);
+	hysteresis = qMax(0.0, fraction);
+}
+
+void WaterfallAutoLevel::setMinimumUpdateInterval(int msec)
+{
+	QMutexLocker locker(&mutex);
+	minimumUpdateInterval = qMax(0, msec);
+}
+
+void WaterfallAutoLevel::reset()
+{
+	QMutexLocker locker(&mutex);
+
+	rows = 0;
+	lowQuantile.reset(lowPercentile);
+	highQuantile.reset(highPercentile);
+	updateTimer.invalidate();
+}
+
+bool WaterfallAutoLevel::update(const double* data, int size)
+{
+	QMutexLocker locker(&mutex);
+
+	if (!bIsEnabled || data == nullptr || size <= 0) return false;
+
+	//the phase walks through the stride so every column is sampled over a few rows
+	const int stride = qMax(1, size / SamplesPerRow);
+	phase = (phase + 1) % stride;
+
+	//size / stride stays below 2 * SamplesPerRow
+	double samples[2 * SamplesPerRow];
+	int count = 0;
+	for (int i = phase; i < size && count < 2 * SamplesPerRow; i += stride)
+	{
+		samples[count++] = data[i];
+	}
+
+	//NaN and infinities are outside of the finite range
+	static const QtInterval finiteRange(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+	quint32 finite[(2 * SamplesPerRow + 31) / 32];
+	finiteRange.contains(samples, count, finite);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!(finite[i / 32] & (1u << (i % 32)))) continue;
+
+		lowQuantile.add(samples[i]);
+		highQuantile.add(samples[i]);
+	}
+
+	if (++rows < window) return false;
+
+	rows = 0;
+	if (lowQuantile.count() == 0) return false;
+
+	lastLow = lowQuantile.value();
+	lastHigh = highQuantile.value();
+
+	lowQuantile.reset(lowPercentile);
+	highQuantile.reset(highPercentile);
+
+	return true;
+}
+
+QtInterval WaterfallAutoLevel::estimate() const
+{
+	QMutexLocker locker(&mutex);
+	return QtInterval(lastLow, lastHigh);
+}
+
+bool WaterfallAutoLevel::accept(const QtInterval& current, const QtInterval& target)
+{
+	QMutexLocker locker(&mutex);
+
+	if (!target.isValid() || target.width() <= 0.0) return false;
+
+	if (current.isValid())
+	{
+		const double threshold = hysteresis * current.width();
+		if (qAbs(target.minValue() - current.minValue()) <= threshold
+			&& qAbs(target.maxValue() - current.maxValue()) <= threshold)
+		{
+			return false;
+		}
+	}
+
+	if (updateTimer.isValid() && updateTimer.elapsed() < minimumUpdateInterval) return false;
+
+	updateTimer.start();
+
+	return true;
+}
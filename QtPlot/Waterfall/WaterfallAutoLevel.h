@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include "Interval.h"
+
+
+/*!
+\brief Streaming quantile estimate (P-square algorithm, Jain & Chlamtac)
+
+Five markers, constant memory and O(1) per sample.
+*/
+class WaterfallQuantile
+{
+public:
+	explicit WaterfallQuantile(double p = 0.5);
+
+	void reset(double p);
+	void add(double x);
+
+	double value() const;
+	inline int count() const { return samples; }
+
+private:
+	double parabolic(int i, double d) const;
+	double linear(int i, int d) const;
+
+private:
+	double	probability;
+	int		samples;
+
+	double	heights[5];
+	double	positions[5];
+	double	desired[5];
+	double	increments[5];
+};
+
+
+/*!
+\brief Automatic level control of the waterfall
+
+Low and high percentiles of the appended rows are estimated over a window of rows,
+only a few samples of every row are fed to the estimators.
+A new interval is proposed when it moved further than the hysteresis
+and the last change is older than the minimum update interval.
+*/
+class WaterfallAutoLevel
+{
+public:
+	enum { SamplesPerRow = 64 };
+
+	WaterfallAutoLevel();
+
+	void setEnabled(bool enable);
+	bool isEnabled() const;
+
+	void setPercentiles(double low, double high);
+	void setWindow(int rows);
+
+	/*!
+	\brief Minimum move of either bound, as a fraction of the current interval width
+	*/
+	void setHysteresis(double fraction);
+	void setMinimumUpdateInterval(int msec);
+
+	void reset();
+
+	/*!
+	\brief Feed a row to the estimators
+
+	\param data Array of double values. Size: size.
+	\param size Width of the row.
+	\return True when a window is complete and a new estimate is available.
+	*/
+	bool update(const double* data, int size);
+
+	/*!
+	\brief Raw (untransformed) low and high percentile of the last complete window
+	*/
+	QtInterval estimate() const;
+
+	/*!
+	\brief Check hysteresis and rate limit, restarts the rate limit timer when the target is accepted
+	*/
+	bool accept(const QtInterval& current, const QtInterval& target);
+
+private:
+	mutable QMutex	mutex;
+
+	WaterfallQuantile	lowQuantile;
+	WaterfallQuantile	highQuantile;
+
+	bool	bIsEnabled = false;
+
+	double	lowPercentile = 0.05;
+	double	highPercentile = 0.99;
+	double	hysteresis = 0.1;
+	int		window = 32;
+	int		minimumUpdateInterval = 500;
+
+	int		rows = 0;
+	int		phase = 0;
+	double	lastLow = 0.0;
+	double	lastHigh = 0.0;
+
+	QElapsedTimer	updateTimer;
+
+};
@@ -2,7 +2,11 @@
 
 #include "ColorMap/WaterfallColorMap.h"
 #include "WaterfallContent.h"
+#include "WaterfallColorScale.h"
 #include "WaterfallThread.h"
+#include "WaterfallExporter.h"
+
+#include <QThreadPool>
 
 
 WaterfallBase::WaterfallBase(QWidget* parent)
@@ -66,6 +70,11 @@ void WaterfallBase::setColorMap(WfColorMap* colorMap) const
 	content->setColorMap(colorMap);
 }
 
+void WaterfallBase::setColorMap(const WfColorMapPtr& colorMap) const
+{
+	content->setColorMap(colorMap);
+}
+
 auto WaterfallBase::setAppendSide(EAppendSide side) -> void
 {
 	content->setAppendSide(side);
@@ -114,6 +123,11 @@ void WaterfallBase::setInterval(int minval, int maxval) const
 	content->setInterval(minval, maxval);
 }
 
+void WaterfallBase::setInterval(const QtInterval& interval) const
+{
+	content->setInterval(interval);
+}
+
 QtInterval WaterfallBase::getInterval() const
 {
 	return content->getInterval();
@@ -123,3 +137,184 @@ void WaterfallBase::setFillColor(const QColor& fillColor) const
 {
 	content->setFillColor(fillColor);
 }
+
+void WaterfallBase::setColorScaleVisible(bool visible /*= true*/)
+{
+	if (visible == getColorScaleVisible()) return;
+
+	if (visible)
+	{
+		if (colorScale == nullptr)
+		{
+			colorScale = new WaterfallColorScale(this);
+
+			//keep the bar aligned with the waterfall axis rect
+			colorScaleMargins = new QCPMarginGroup(this);
+			axisRect()->setMarginGroup(QCP::msTop | QCP::msBottom, colorScaleMargins);
+			colorScale->setMarginGroup(QCP::msTop | QCP::msBottom, colorScaleMargins);
+
+			//the scale lives in this thread, changes from the ingest thread are queued
+			connect(content, &WaterfallContent::colorMapChanged, colorScale, [=]() { syncColorScaleMap(); });
+			connect(content, &WaterfallContent::intervalChanged, colorScale, [=]() { syncColorScaleInterval(); });
+		}
+
+		plotLayout()->addElement(0, 1, colorScale);
+		colorScale->setVisible(true);
+
+		colorScale->setColorMap(content->getColorMap());
+		colorScale->setInterval(content->getInterval());
+	}
+	else
+	{
+		//a taken element still draws on its layer
+		plotLayout()->take(colorScale);
+		plotLayout()->simplify();
+		colorScale->setVisible(false);
+	}
+
+	//the layout changed, a full replot is needed once
+	replot();
+}
+
+bool WaterfallBase::getColorScaleVisible() const
+{
+	return colorScale != nullptr && colorScale->layout() != nullptr;
+}
+
+void WaterfallBase::syncColorScaleMap()
+{
+	colorScale->setColorMap(content->getColorMap());
+	colorScale->replotScale();
+}
+
+void WaterfallBase::syncColorScaleInterval()
+{
+	colorScale->setInterval(content->getInterval());
+	colorScale->replotScale();
+}
+
+void WaterfallBase::setResampleMode(EResampleMode mode) const
+{
+	content->setResampleMode(mode);
+}
+
+void WaterfallBase::setDirectBlit(bool enable /*= true*/) const
+{
+	content->setDirectBlit(enable);
+}
+
+void WaterfallBase::setAccumulatorEnabled(EWaterfallTrace trace, bool enable /*= true*/) const
+{
+	content->setAccumulatorEnabled(trace, enable);
+}
+
+void WaterfallBase::setAverageFactor(double alpha) const
+{
+	content->setAverageFactor(alpha);
+}
+
+void WaterfallBase::resetAccumulators() const
+{
+	content->resetAccumulators();
+}
+
+void WaterfallBase::setDisplayTrace(EWaterfallTrace trace) const
+{
+	content->setDisplayTrace(trace);
+}
+
+QVector<double> WaterfallBase::getAccumulatorTrace(EWaterfallTrace trace) const
+{
+	return content->getAccumulatorTrace(trace);
+}
+
+void WaterfallBase::setAutoLevelEnabled(bool enable /*= true*/) const
+{
+	content->setAutoLevelEnabled(enable);
+}
+
+bool WaterfallBase::getAutoLevelEnabled() const
+{
+	return content->getAutoLevelEnabled();
+}
+
+void WaterfallBase::setAutoLevelPercentiles(double low, double high) const
+{
+	content->setAutoLevelPercentiles(low, high);
+}
+
+void WaterfallBase::setAutoLevelWindow(int rows) const
+{
+	content->setAutoLevelWindow(rows);
+}
+
+void WaterfallBase::setAutoLevelHysteresis(double fraction) const
+{
+	content->setAutoLevelHysteresis(fraction);
+}
+
+void WaterfallBase::setAutoLevelMinimumInterval(int msec) const
+{
+	content->setAutoLevelMinimumInterval(msec);
+}
+
+WaterfallSnapshot WaterfallBase::snapshot() const
+{
+	return content->snapshot();
+}
+
+void WaterfallBase::exportSnapshot(const QString& fileName, EExportFormat format)
+{
+	auto exporter = new WaterfallExporter(content->snapshot(), fileName, format);
+	connect(exporter, &WaterfallExporter::finished, this, &WaterfallBase::exportFinished);
+
+	QThreadPool::globalInstance()->start(exporter);
+}
+
+WaterfallLatencyHistogram WaterfallBase::getLatencyHistogram(EWaterfallStage stage) const
+{
+#ifdef QTPLOT_WATERFALL_PROFILING
+	return content->getProfiler().histogram(stage);
+#else
+	Q_UNUSED(stage)
+	return WaterfallLatencyHistogram();
+#endif
+}
+
+QVector<WaterfallLatencyHistogram> WaterfallBase::getLatencyHistograms() const
+{
+#ifdef QTPLOT_WATERFALL_PROFILING
+	return content->getProfiler().histograms();
+#else
+	return QVector<WaterfallLatencyHistogram>();
+#endif
+}
+
+void WaterfallBase::resetLatencyStatistics() const
+{
+#ifdef QTPLOT_WATERFALL_PROFILING
+	content->getProfiler().reset();
+#endif
+}
+
+void WaterfallBase::setLatencyReportInterval(int msec)
+{
+#ifdef QTPLOT_WATERFALL_PROFILING
+	if (!latencyTimer)
+	{
+		latencyTimer = new QTimer(this);
+		connect(latencyTimer, &QTimer::timeout, [=]() { emit latencyStatisticsUpdated(getLatencyHistograms()); });
+	}
+
+	if (msec > 0)
+	{
+		latencyTimer->start(msec);
+	}
+	else
+	{
+		latencyTimer->stop();
+	}
+#else
+	Q_UNUSED(msec)
+#endif
+}
@@ -9,6 +9,7 @@
 //forward declaration
 class WaterfallThread;
 class WaterfallContent;
+class WaterfallColorScale;
 
 
 class QTPLOT_EXPORT WaterfallBase : public QtPlot
@@ -29,6 +30,7 @@ public:
 	void setAutoUpdate(bool bAuto = true);
 	void setFPSLimit(quint32 fps = 0) const;
 	void setColorMap(WfColorMap* colorMap) const;
+	void setColorMap(const WfColorMapPtr& colorMap) const;
 	void setAppendSide(EAppendSide side);;
 	void setAppendHeight(int h) const;
 	void setResolution(int width, int height) const;
@@ -38,22 +40,90 @@ public:
 	void setPositionX(int minx, int maxx) const;
 	void setPositionY(int miny, int maxy) const;
 	virtual void setInterval(int minval, int maxval) const;
+	void setInterval(const QtInterval& interval) const;
 
 	inline bool getAutoUpdate() const { return loadThread->getAutoUpdate(); }
 	inline quint32 getFPSLimit() const { return loadThread->getFPSLimit(); }
-	inline WfColorMap* getColorMap() const { return content->getColorMap(); }
+	inline WfColorMapPtr getSharedColorMap() const { return content->getColorMap(); }
+
+	/*!
+	\brief Raw pointer to the color map, kept for source compatibility
+
+	The map is shared with other waterfalls and threads and must not be modified,
+	the pointer is valid until the next setColorMap(). Use getSharedColorMap().
+	*/
+	Q_DECL_DEPRECATED inline WfColorMap* getColorMap() const { return const_cast<WfColorMap*>(content->getColorMap().data()); }
 	inline QRect getResolution() const { return content->getResolution(); }
 
 	QtInterval getInterval() const;
 
 	void setFillColor(const QColor& fillColor) const;
 
+	/*!
+	\brief Show the color bar right of the waterfall
+
+	The bar follows the color map and the interval of the waterfall (automatic level control included)
+	and replots only its own layer on a change.
+	*/
+	void setColorScaleVisible(bool visible = true);
+	bool getColorScaleVisible() const;
+	inline WaterfallColorScale* getColorScale() const { return colorScale; }
+
+	void setResampleMode(EResampleMode mode) const;
+	void setDirectBlit(bool enable = true) const;
+
+	//persistence planes (max-hold / average / min-hold)
+	void setAccumulatorEnabled(EWaterfallTrace trace, bool enable = true) const;
+	void setAverageFactor(double alpha) const;
+	void resetAccumulators() const;
+	void setDisplayTrace(EWaterfallTrace trace) const;
+	QVector<double> getAccumulatorTrace(EWaterfallTrace trace) const;
+
+	//automatic level control, the interval follows percentiles of the incoming rows
+	void setAutoLevelEnabled(bool enable = true) const;
+	bool getAutoLevelEnabled() const;
+	void setAutoLevelPercentiles(double low, double high) const;
+	void setAutoLevelWindow(int rows) const;
+	void setAutoLevelHysteresis(double fraction) const;
+	void setAutoLevelMinimumInterval(int msec) const;
+
+	/*!
+	\brief Snapshot of the image and (WaterfallWithMemory) the value history, shared row by row
+	*/
+	WaterfallSnapshot snapshot() const;
+
+	/*!
+	\brief Export a snapshot from a background thread, exportFinished is emitted when done
+	*/
+	void exportSnapshot(const QString& fileName, EExportFormat format);
+
+	/*
+		Pipeline latency statistics (see WaterfallProfiler).
+		Empty unless the library is built with QTPLOT_WATERFALL_PROFILING.
+	*/
+	WaterfallLatencyHistogram getLatencyHistogram(EWaterfallStage stage) const;
+	QVector<WaterfallLatencyHistogram> getLatencyHistograms() const;
+	void resetLatencyStatistics() const;
+	void setLatencyReportInterval(int msec);
+
 signals:
 	void copyingCompleted();
+	void exportFinished(const QString& fileName, bool success);
+	void latencyStatisticsUpdated(const QVector<WaterfallLatencyHistogram>& histograms);
 
 protected:
 	WaterfallThread* loadThread;
 	WaterfallContent* content = nullptr;
 
+private:
+	void syncColorScaleMap();
+	void syncColorScaleInterval();
+
+private:
+	QTimer* latencyTimer = nullptr;
+
+	WaterfallColorScale*	colorScale = nullptr;
+	QCPMarginGroup*			colorScaleMargins = nullptr;
+
 };
 
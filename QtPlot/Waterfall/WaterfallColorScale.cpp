@@ -0,0 +1,101 @@
+#include "WaterfallColorScale.h"
+
+#include "QtPlotGlobal.h"
+
+
+WaterfallColorScale::WaterfallColorScale(QCustomPlot* parentPlot)
+	: QCPAxisRect(parentPlot, false)
+{
+	QCPLayer* scaleLayer = parentPlot->layer(COLOR_SCALE_LAYER_NAME);
+	if (scaleLayer == nullptr)
+	{
+		parentPlot->addLayer(COLOR_SCALE_LAYER_NAME);
+		scaleLayer = parentPlot->layer(COLOR_SCALE_LAYER_NAME);
+		scaleLayer->setMode(QCPLayer::lmBuffered);
+	}
+
+	QCPAxis* valueAxis = addAxis(QCPAxis::atRight);
+	valueAxis->grid()->setVisible(false);
+	valueAxis->setLayer(scaleLayer);
+	valueAxis->grid()->setLayer(scaleLayer);
+	setLayer(scaleLayer);
+
+	setRangeDrag(Qt::Orientations());
+	setRangeZoom(Qt::Orientations());
+
+	setBarWidth(barWidth);
+}
+
+WaterfallColorScale::~WaterfallColorScale()
+{
+}
+
+void WaterfallColorScale::setColorMap(const WfColorMapPtr& inColorMap)
+{
+	if (colorMap == inColorMap) return;
+
+	colorMap = inColorMap;
+	gradientInvalidated = true;
+}
+
+void WaterfallColorScale::setInterval(const QtInterval& interval)
+{
+	if (!interval.isValid()) return;
+
+	getAxis()->setRange(interval.minValue(), interval.maxValue());
+}
+
+QtInterval WaterfallColorScale::getInterval() const
+{
+	const QCPRange range = getAxis()->range();
+	return QtInterval(range.lower, range.upper);
+}
+
+void WaterfallColorScale::setBarWidth(int width)
+{
+	barWidth = qMax(1, width);
+
+	setMinimumSize(barWidth, 0);
+	setMaximumSize(barWidth, QWIDGETSIZE_MAX);
+}
+
+void WaterfallColorScale::replotScale()
+{
+	if (layer())
+	{
+		layer()->replot();
+	}
+}
+
+void WaterfallColorScale::draw(QCPPainter* painter)
+{
+	QCPAxisRect::draw(painter);
+
+	if (colorMap.isNull() || mRect.height() <= 0) return;
+
+	if (gradientInvalidated || gradientImage.height() != mRect.height())
+	{
+		updateGradientImage(mRect.height());
+	}
+
+	painter->drawImage(mRect, getAxis()->rangeReversed() ? gradientImage.mirrored() : gradientImage);
+}
+
+void WaterfallColorScale::updateGradientImage(int height)
+{
+	QVector<QRgb> colors(height);
+	colorMap->palette(colors.data(), height);
+
+	const bool premultiplied = colorMap->isPremultiplied();
+
+	gradientImage = QImage(1, height, QImage::Format_ARGB32_Premultiplied);
+
+	//the minimum is at the bottom of the bar
+	for (int i = 0; i < height; i++)
+	{
+		const QRgb color = colors[i];
+		*reinterpret_cast<QRgb*>(gradientImage.scanLine(height - 1 - i)) = premultiplied ? color : qPremultiply(color);
+	}
+
+	gradientInvalidated = false;
+}
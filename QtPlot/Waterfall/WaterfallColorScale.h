@@ -0,0 +1,55 @@
+#pragma once
+
+#include "QCustomPlot/QCustomPlot.h"
+
+#include "Interval.h"
+#include "ColorMap/WfColorMap.h"
+
+
+/*!
+\brief Color bar of a waterfall
+
+Axis rect with one value axis, placed in the plot layout next to the waterfall.
+The gradient is rendered once into a cached image, one pixel per row of the bar,
+and rebuilt only when the color map or the height of the bar changes.
+
+The element and its axis live on their own buffered layer, an interval or color map change
+replots that layer only. Tick label widths are taken into account on the next full replot.
+*/
+class WaterfallColorScale : public QCPAxisRect
+{
+	Q_OBJECT
+
+public:
+	explicit WaterfallColorScale(QCustomPlot* parentPlot);
+	~WaterfallColorScale() override;
+
+	void setColorMap(const WfColorMapPtr& colorMap);
+	inline WfColorMapPtr getColorMap() const { return colorMap; }
+
+	void setInterval(const QtInterval& interval);
+	QtInterval getInterval() const;
+
+	void setBarWidth(int width);
+	inline int getBarWidth() const { return barWidth; }
+
+	inline QCPAxis* getAxis() const { return axis(QCPAxis::atRight); }
+
+	/*!
+	\brief Replot the color scale layer only
+	*/
+	void replotScale();
+
+protected:
+	void draw(QCPPainter* painter) override;
+
+private:
+	void updateGradientImage(int height);
+
+private:
+	WfColorMapPtr	colorMap;
+	QImage			gradientImage;
+	bool			gradientInvalidated = true;
+	int				barWidth = 20;
+
+};
@@ -2,19 +2,35 @@
 
 #include "ColorMap/WfColorMap.h"
 #include "WaterfallLayer.h"
+#include "WaterfallIndexPlane.h"
+#include "WaterfallAccumulator.h"
+#include "WaterfallAutoLevel.h"
+#include "WaterfallResampler.h"
+#include "WaterfallScaler.h"
 #include "Library/QtPlotMathLibrary.h"
 #include "Plot/QtPlot.h"
 
+#include <qmath.h>
+#include <algorithm>
+
 
 WaterfallContent::WaterfallContent(QCustomPlot* parent)
 	: QCPItemPixmap(parent),
 	waterfallLayer(nullptr),
 	appendSide(EAS_Top),
-	appendHeight(1)
+	appendHeight(1),
+	displayTrace(EWT_Raw)
 {
 	parentQtPlot = reinterpret_cast<QtPlot*>(parent);
 	readWriteLock = new QReadWriteLock(QReadWriteLock::Recursive);
 	readWritePixmap = new QReadWriteLock();
+	resampler = new WaterfallResampler();
+
+	//levels are estimated in the ingest thread, the recolor runs in the owner thread
+	connect(this, &WaterfallContent::autoLevelChanged, this, QOverload<const QtInterval&>::of(&WaterfallContent::setInterval), Qt::QueuedConnection);
+
+	accumulator = new WaterfallAccumulator();
+	autoLevel = new WaterfallAutoLevel();
 	setScaled(true, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 }
 
@@ -36,26 +52,62 @@ WaterfallContent::~WaterfallContent()
 
 	delete readWritePixmap;
 	readWritePixmap = nullptr;
+
+	delete accumulator;
+	accumulator = nullptr;
+
+	delete autoLevel;
+	autoLevel = nullptr;
+
+	delete resampler;
+	resampler = nullptr;
 }	
 
 void WaterfallContent::setColorMap(WfColorMap* inColorMap)
 {
 	if (inColorMap == nullptr) return;
 
-	readWriteLock->lockForWrite();
+	setColorMap(WfColorMapPtr(inColorMap));
+}
 
-	if (waterfallLayer != nullptr)
+void WaterfallContent::setColorMap(const WfColorMapPtr& inColorMap)
+{
+	if (inColorMap.isNull()) return;
+
+	readWriteLock->lockForRead();
+	if (waterfallLayer == nullptr)
 	{
-		delete waterfallLayer->colorMap;
-		waterfallLayer->colorMap = inColorMap;
+		readWriteLock->unlock();
+		return;
 	}
+	const QColor fillColor = waterfallLayer->fillColor;
+	const QImage::Format format = waterfallLayer->format;
+	readWriteLock->unlock();
+
+	const QVector<QRgb> palette = WaterfallIndexPlane::makePalette(inColorMap.data(), fillColor, format);
+
+	//the previous map is released after the lock
+	WfColorMapPtr previousColorMap = inColorMap;
+
+	readWriteLock->lockForWrite();
+
+	waterfallLayer->colorMap.swap(previousColorMap);
+
+	//existing rows are recolored from their indexes
+	waterfallLayer->indexPlane->setPalette(palette);
+	waterfallLayer->indexPlane->colorize(waterfallLayer->image);
+	updatePixmap();
 
 	readWriteLock->unlock();
+
+	update();
+
+	emit colorMapChanged();
 }
 
-WfColorMap* WaterfallContent::getColorMap()
+WfColorMapPtr WaterfallContent::getColorMap() const
 {
-	WfColorMap* colorMap = nullptr;
+	WfColorMapPtr colorMap;
 	readWriteLock->lockForRead();
 	if(waterfallLayer)
 	{
@@ -76,13 +128,43 @@ void WaterfallContent::setAppendSide(EAppendSide side)
 
 void WaterfallContent::updatePixmap()
 {
+	WF_PROFILE_SCOPE(profiler, EWS_UpdatePixmap);
+
+	imageRevision.fetchAndAddOrdered(1);
+
+	//pixmap is converted on demand in draw()
+	if (directBlit.loadAcquire()) return;
+
+	convertPixmap();
+}
+
+void WaterfallContent::convertPixmap()
+{
+	const int revision = imageRevision.loadAcquire();
+
 	readWritePixmap->lockForWrite();
 	const QPixmap newPixmap = QPixmap::fromImage(*waterfallLayer->image);
 	if (newPixmap.isNull()) qDebug() << "pixmap is null!!!" << waterfallLayer->image->rect();
 	setPixmap(newPixmap);
+	pixmapRevision = revision;
 	readWritePixmap->unlock();
 }
 
+void WaterfallContent::setDirectBlit(bool enable)
+{
+	directBlit.storeRelease(enable ? 1 : 0);
+
+	scaledImage = QImage();
+	scaledImageRevision = -1;
+
+	update();
+}
+
+bool WaterfallContent::getDirectBlit() const
+{
+	return directBlit.loadAcquire() != 0;
+}
+
 void WaterfallContent::update()
 {
 	parentPlot()->layer(WATERFALL_LAYER_NAME)->replot();
@@ -110,6 +192,7 @@ void WaterfallContent::setResolution(int width, int height)
 		qDebug() << "Can't create Image(" << width << "," << height << ")";
 	}
 	waterfallLayer->image->fill(waterfallLayer->fillColor);
+	waterfallLayer->indexPlane->resize(width, height);
 	update();
 
 	readWriteLock->unlock();
@@ -165,6 +248,9 @@ void WaterfallContent::setFillColor(const QColor& fillColor)
 	
 	waterfallLayer->fillColor = fillColor;
 	waterfallLayer->image->fill(fillColor);
+	waterfallLayer->indexPlane->clear();
+	waterfallLayer->indexPlane->setPalette(
+		WaterfallIndexPlane::makePalette(waterfallLayer->colorMap.data(), fillColor, waterfallLayer->format));
 	updatePixmap();
 
 	readWriteLock->unlock();
@@ -173,11 +259,16 @@ void WaterfallContent::setFillColor(const QColor& fillColor)
 }
 
 void WaterfallContent::setInterval(int minval, int maxval)
+{
+	setInterval(QtInterval(minval, maxval));
+}
+
+void WaterfallContent::setInterval(const QtInterval& interval)
 {
 	readWriteLock->lockForRead();
 	{
-		if(equals(minval, waterfallLayer->range.minValue()) 
-			&& equals(maxval, waterfallLayer->range.maxValue()))
+		if(equals(interval.minValue(), waterfallLayer->range.minValue()) 
+			&& equals(interval.maxValue(), waterfallLayer->range.maxValue()))
 		{
 			readWriteLock->unlock();
 			return;
@@ -189,26 +280,11 @@ void WaterfallContent::setInterval(int minval, int maxval)
 	{
 		if (waterfallLayer->range.isValid())
 		{
-			const auto currentInterval = waterfallLayer->range;
-			waterfallLayer->range = QtInterval(minval, maxval);
+			waterfallLayer->range = interval;
 
-			for (int h = 0; h < waterfallLayer->image->height(); h++)
-			{
-				auto line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(h));
-
-				for (int w = 0; w < waterfallLayer->image->width(); w++)
-				{
-					double oldValue = waterfallLayer->colorMap->RGB2Double(currentInterval, *line);
-					if(equals(oldValue, 0.0))
-					{
-						*line++;
-						continue;
-					}
-					oldValue = currentInterval.minValue() + oldValue * currentInterval.width();
-
-					*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, oldValue);
-				}
-			}
+			//recolor from the stored indexes, they keep their own interval and are not rewritten
+			waterfallLayer->indexPlane->setDisplayInterval(waterfallLayer->range);
+			waterfallLayer->indexPlane->colorize(waterfallLayer->image);
 		}
 	}
 	readWriteLock->unlock();
@@ -218,6 +294,8 @@ void WaterfallContent::setInterval(int minval, int maxval)
 
 		update();
 	}
+
+	emit intervalChanged();
 }
 
 QtInterval WaterfallContent::getInterval() const
@@ -267,6 +345,8 @@ void WaterfallContent::clear()
 	readWriteLock->lockForRead();
 	
 	waterfallLayer->image->fill(waterfallLayer->fillColor);
+	waterfallLayer->indexPlane->clear();
+	accumulator->reset();
 	updatePixmap();
 
 	readWriteLock->unlock();
@@ -274,34 +354,176 @@ void WaterfallContent::clear()
 	update();
 }
 
-void WaterfallContent::append(double* data, int size, bool needUpdatePixmap/* = true*/)
+WaterfallSnapshot WaterfallContent::snapshot() const
+{
+	WaterfallSnapshot result;
+
+	readWriteLock->lockForWrite();
+	if (waterfallLayer)
+	{
+		fillSnapshot(result);
+	}
+	readWriteLock->unlock();
+
+	return result;
+}
+
+void WaterfallContent::fillSnapshot(WaterfallSnapshot& snapshot) const
+{
+	//a shared image would be detached by the next append, on the ingest thread;
+	//the copy costs about as much as one scroll of the image in append
+	snapshot.image = waterfallLayer->image->copy();
+	snapshot.interval = waterfallLayer->range;
+}
+
+void WaterfallContent::setAccumulatorEnabled(EWaterfallTrace trace, bool enable)
+{
+	accumulator->setEnabled(trace, enable);
+}
+
+void WaterfallContent::setAverageFactor(double alpha)
+{
+	accumulator->setAverageFactor(alpha);
+}
+
+void WaterfallContent::resetAccumulators()
+{
+	accumulator->reset();
+}
+
+QVector<double> WaterfallContent::getAccumulatorTrace(EWaterfallTrace trace) const
+{
+	return accumulator->trace(trace);
+}
+
+void WaterfallContent::setResampleMode(EResampleMode mode)
+{
+	readWriteLock->lockForWrite();
+	resampler->setMode(mode);
+	readWriteLock->unlock();
+}
+
+EResampleMode WaterfallContent::getResampleMode() const
 {
 	readWriteLock->lockForRead();
-	
-	switch (appendSide)
+	const EResampleMode mode = resampler->getMode();
+	readWriteLock->unlock();
+
+	return mode;
+}
+
+void WaterfallContent::setDisplayTrace(EWaterfallTrace trace)
+{
+	readWriteLock->lockForWrite();
+	displayTrace = trace;
+	readWriteLock->unlock();
+}
+
+EWaterfallTrace WaterfallContent::getDisplayTrace() const
+{
+	readWriteLock->lockForRead();
+	const EWaterfallTrace trace = displayTrace;
+	readWriteLock->unlock();
+
+	return trace;
+}
+
+void WaterfallContent::setAutoLevelEnabled(bool enable)
+{
+	autoLevel->setEnabled(enable);
+}
+
+bool WaterfallContent::getAutoLevelEnabled() const
+{
+	return autoLevel->isEnabled();
+}
+
+void WaterfallContent::setAutoLevelPercentiles(double low, double high)
+{
+	autoLevel->setPercentiles(low, high);
+}
+
+void WaterfallContent::setAutoLevelWindow(int rows)
+{
+	autoLevel->setWindow(rows);
+}
+
+void WaterfallContent::setAutoLevelHysteresis(double fraction)
+{
+	autoLevel->setHysteresis(fraction);
+}
+
+void WaterfallContent::setAutoLevelMinimumInterval(int msec)
+{
+	autoLevel->setMinimumUpdateInterval(msec);
+}
+
+void WaterfallContent::append(double* inData, int size, bool needUpdatePixmap/* = true*/)
+{
+	if (inData == nullptr || size <= 0) return;
+
+	readWriteLock->lockForRead();
+
+	const bool isVertical = appendSide == EAS_Top || appendSide == EAS_Bottom;
+	const int imageSize = isVertical ? waterfallLayer->image->width() : waterfallLayer->image->height();
+
+	const double* data = resampler->resample(inData, size, imageSize);
+	size = imageSize;
+
+	data = accumulator->update(data, size, displayTrace, displayRow);
+	storeRow(data, size);
+
+	bool levelChanged = false;
+	QtInterval level;
+	if (autoLevel->update(data, size))
 	{
-		case EAS_Top:
-		{
-			appendT(data, size, appendHeight);
-			break;
-		}
+		const QtInterval estimate = autoLevel->estimate();
+		double low = waterfallLayer->colorMap->transformValue(estimate.minValue());
+		double high = waterfallLayer->colorMap->transformValue(estimate.maxValue());
 
-		case EAS_Bottom:
+		if (qIsFinite(low) && qIsFinite(high))
 		{
-			appendB(data, size, appendHeight);
-			break;
-		}
+			//flat rows, keep a nonzero width around the level
+			if (!(high > low))
+			{
+				const double pad = low != 0.0 ? qAbs(low) * 0.5e-3 : 0.5;
+				low -= pad;
+				high += pad;
+			}
 
-		case EAS_Left:
-		{
-			appendL(data, size, appendHeight);
-			break;
+			level = QtInterval(low, high);
+			levelChanged = autoLevel->accept(waterfallLayer->range, level);
 		}
+	}
+	
+	{
+		WF_PROFILE_SCOPE(profiler, EWS_Colorize);
 
-		case EAS_Right:
+		switch (appendSide)
 		{
-			appendR(data, size, appendHeight);
-			break;
+			case EAS_Top:
+			{
+				appendT(data, size, appendHeight);
+				break;
+			}
+
+			case EAS_Bottom:
+			{
+				appendB(data, size, appendHeight);
+				break;
+			}
+
+			case EAS_Left:
+			{
+				appendL(data, size, appendHeight);
+				break;
+			}
+
+			case EAS_Right:
+			{
+				appendR(data, size, appendHeight);
+				break;
+			}
 		}
 	}
 
@@ -311,6 +533,12 @@ void WaterfallContent::append(double* data, int size, bool needUpdatePixmap/* =
 	}
 
 	readWriteLock->unlock();
+
+	//setInterval takes the write lock, never request it while the read lock is held
+	if (levelChanged)
+	{
+		emit autoLevelChanged(level);
+	}
 }
 
 void WaterfallContent::setData(double* data, int width, int height)
@@ -361,10 +589,13 @@ bool WaterfallContent::createLayer(qint32 inWidth, qint32 inHeight, qreal minx,
 	waterfallLayer->format = fm;
 	waterfallLayer->image->fill(fil);
 	waterfallLayer->fillColor = fil;
+	waterfallLayer->indexPlane->resize(inWidth, inHeight);
+	waterfallLayer->indexPlane->setPalette(WaterfallIndexPlane::makePalette(nullptr, fil, fm));
 
 	updatePixmap();
 
 	waterfallLayer->range = QtInterval(minval, maxval);
+	waterfallLayer->indexPlane->setDisplayInterval(waterfallLayer->range);
 
 	topLeft->setCoords(minx, maxy);
 	bottomRight->setCoords(maxx, miny);
@@ -374,7 +605,11 @@ bool WaterfallContent::createLayer(qint32 inWidth, qint32 inHeight, qreal minx,
 	return true;
 }
 
-void WaterfallContent::appendT(double* data, int w, int h)
+void WaterfallContent::storeRow(const double* /*data*/, int /*size*/)
+{
+}
+
+void WaterfallContent::appendT(const double* data, int w, int h)
 {
 	if (waterfallLayer->image->width() > w)
 	{
@@ -388,18 +623,23 @@ void WaterfallContent::appendT(double* data, int w, int h)
 		imageData, 
 		waterfallLayer->image->sizeInBytes() - waterfallLayer->image->bytesPerLine() * h);
 
-	while (y < h)
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	indexPlane->scrollRows(h);
+
+	quint16* firstIndexes = indexPlane->scanLine(0);
+	waterfallLayer->colorMap->indexRow(indexPlane->interval(), data, firstIndexes, w, WaterfallIndexPlane::Levels);
+
+	QRgb* firstLine = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(0));
+	indexPlane->colorize(firstIndexes, firstLine, w);
+
+	for (y = 1; y < h; y++)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(y));
-		for (int x = 0; x < w; x++)
-		{
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x]);
-		}
-		y++;
+		memcpy(waterfallLayer->image->scanLine(y), firstLine, w * sizeof(QRgb));
+		memcpy(indexPlane->scanLine(y), firstIndexes, w * sizeof(quint16));
 	}
 }
 
-void WaterfallContent::appendB(double* data, int w, int h)
+void WaterfallContent::appendB(const double* data, int w, int h)
 {
 	if (waterfallLayer->image->width() > w)
 	{
@@ -413,16 +653,25 @@ void WaterfallContent::appendB(double* data, int w, int h)
 		imageData + waterfallLayer->image->bytesPerLine() * h, 
 		waterfallLayer->image->sizeInBytes() - waterfallLayer->image->bytesPerLine() * h);
 
-	while (y >= 1) 
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	indexPlane->scrollRows(-h);
+
+	const int height = waterfallLayer->image->height();
+
+	quint16* firstIndexes = indexPlane->scanLine(height - y);
+	waterfallLayer->colorMap->indexRow(indexPlane->interval(), data, firstIndexes, w, WaterfallIndexPlane::Levels);
+
+	QRgb* firstLine = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(height - y));
+	indexPlane->colorize(firstIndexes, firstLine, w);
+
+	for (y = h - 1; y >= 1; y--)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(waterfallLayer->image->height() - y));
-		for (int x = 0; x < w; x++)
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x]);
-		y--;
+		memcpy(waterfallLayer->image->scanLine(height - y), firstLine, w * sizeof(QRgb));
+		memcpy(indexPlane->scanLine(height - y), firstIndexes, w * sizeof(quint16));
 	}
 }
 
-void WaterfallContent::appendL(double* data, int w, int h)
+void WaterfallContent::appendL(const double* data, int w, int h)
 {
 	if (waterfallLayer->image->height() > w) 
 	{
@@ -431,20 +680,26 @@ void WaterfallContent::appendL(double* data, int w, int h)
 	}
 
 	const qint32 bpp = waterfallLayer->image->depth() / 8;
-	qint32 offset = 0;
 
-	for (int i = 0; i < w; i++)
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	indexPlane->scrollColumns(h);
+
+	rowIndexes.resize(w);
+	waterfallLayer->colorMap->indexRow(indexPlane->interval(), data, rowIndexes.data(), w, WaterfallIndexPlane::Levels);
+
+	const int rows = qMin(w, waterfallLayer->image->height());
+	for (int i = 0; i < rows; i++)
 	{
 		uchar* line = waterfallLayer->image->scanLine(i);
 		memmove(line + h * bpp, line, waterfallLayer->image->bytesPerLine() - h * bpp);
-		QRgb* lina = reinterpret_cast<QRgb*>(line);
-		for (int x = offset; x <= offset + h; x++)
-			*lina++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[i]);
-		offset += h;
+
+		quint16* indexLine = indexPlane->scanLine(i);
+		std::fill_n(indexLine, h, rowIndexes[i]);
+		indexPlane->colorize(indexLine, reinterpret_cast<QRgb*>(line), h);
 	}
 }
 
-void WaterfallContent::appendR(double* data, int w, int h)
+void WaterfallContent::appendR(const double* data, int w, int h)
 {
 	if (waterfallLayer->image->height() > w)
 	{
@@ -453,16 +708,23 @@ void WaterfallContent::appendR(double* data, int w, int h)
 	}
 
 	const qint32 bpp = waterfallLayer->image->depth() / 8;
-	qint32 offset = 0;
+	const int width = waterfallLayer->image->width();
+
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	indexPlane->scrollColumns(-h);
 
-	for (int i = 0; i < w; i++)
+	rowIndexes.resize(w);
+	waterfallLayer->colorMap->indexRow(indexPlane->interval(), data, rowIndexes.data(), w, WaterfallIndexPlane::Levels);
+
+	const int rows = qMin(w, waterfallLayer->image->height());
+	for (int i = 0; i < rows; i++)
 	{
 		uchar* line = waterfallLayer->image->scanLine(i);
 		memmove(line, line + h * bpp, waterfallLayer->image->bytesPerLine() - h * bpp);
-		QRgb* lina = reinterpret_cast<QRgb*>(line + waterfallLayer->image->bytesPerLine() - h * bpp);
-		for (int x = offset; x <= offset + h; x++)
-			*lina++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[i]);
-		offset += h;
+
+		quint16* indexLine = indexPlane->scanLine(i) + width - h;
+		std::fill_n(indexLine, h, rowIndexes[i]);
+		indexPlane->colorize(indexLine, reinterpret_cast<QRgb*>(line) + width - h, h);
 	}
 }
 
@@ -476,15 +738,14 @@ void WaterfallContent::setFullDataT(double* data, int w, int h, int /*appendHeig
 		return;
 	}
 
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+
 	for(int y = 0; y < h; y++)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(y));
 		const int offset = (h - 1 - y) * w;
 
-		for (int x = 0; x < w; x++)
-		{
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x + offset]);
-		}
+		waterfallLayer->colorMap->indexRow(indexPlane->interval(), data + offset, indexPlane->scanLine(y), w, WaterfallIndexPlane::Levels);
+		indexPlane->colorizeRow(y, waterfallLayer->image);
 	}
 }
 
@@ -497,15 +758,14 @@ void WaterfallContent::setFullDataB(double* data, int w, int h, int appendHeight
 		return;
 	}
 
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+
 	for (int y = h - 1; y >= 0; y--)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(y));
 		const int offset = y * w;
 
-		for (int x = 0; x < w; x++)
-		{
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x + offset]);
-		}
+		waterfallLayer->colorMap->indexRow(indexPlane->interval(), data + offset, indexPlane->scanLine(y), w, WaterfallIndexPlane::Levels);
+		indexPlane->colorizeRow(y, waterfallLayer->image);
 	}
 }
 
@@ -519,13 +779,21 @@ void WaterfallContent::setFullDataR(double* data, int w, int h, int /*appendHeig
 		return;
 	}
 
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	rowIndexes.resize(h);
+
+	//the data is stored by columns
+	for (int x = 0; x < w; x++)
+	{
+		waterfallLayer->colorMap->indexRow(indexPlane->interval(), data + x * h, rowIndexes.data(), h, WaterfallIndexPlane::Levels);
+
+		for (int y = 0; y < h; y++)
+			indexPlane->scanLine(y)[x] = rowIndexes[y];
+	}
+
 	for (int y = 0; y < h; y++)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(y));
-		for (int x = 0; x < w; x++)
-		{
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x*h + y]);
-		}
+		indexPlane->colorizeRow(y, waterfallLayer->image);
 	}
 }
 
@@ -538,18 +806,28 @@ void WaterfallContent::setFullDataL(double* data, int w, int h, int appendHeight
 		return;
 	}
 
+	WaterfallIndexPlane* indexPlane = waterfallLayer->indexPlane;
+	rowIndexes.resize(h);
+
+	//the data is stored by columns, the last column is drawn first
+	for (int x = 0; x < w; x++)
+	{
+		waterfallLayer->colorMap->indexRow(indexPlane->interval(), data + x * h, rowIndexes.data(), h, WaterfallIndexPlane::Levels);
+
+		for (int y = 0; y < h; y++)
+			indexPlane->scanLine(y)[w - 1 - x] = rowIndexes[y];
+	}
+
 	for (int y = 0; y < h; y++)
 	{
-		QRgb* line = reinterpret_cast<QRgb*>(waterfallLayer->image->scanLine(y));
-		for (int x = w - 1; x >= 0; x--)
-		{
-			*line++ = waterfallLayer->colorMap->rgb(waterfallLayer->range, data[x * h + y]);
-		}
+		indexPlane->colorizeRow(y, waterfallLayer->image);
 	}
 }
 
 void WaterfallContent::draw(QCPPainter* painter)
 {
+	WF_PROFILE_SCOPE(profiler, EWS_Draw);
+
 	bool flipHorz = false;
 	bool flipVert = false;
 	QRect rect = getFinalRect(&flipHorz, &flipVert);
@@ -557,8 +835,25 @@ void WaterfallContent::draw(QCPPainter* painter)
 	QRect boundingRect = rect.adjusted(-clipPad, -clipPad, clipPad, clipPad);
 	if (boundingRect.intersects(clipRect()))
 	{
-		setupScaledPixmap(rect);
-		painter->drawPixmap(clipRect().topLeft(), mScaledPixmap);
+		if (canDirectBlit())
+		{
+			if (setupScaledImage())
+				painter->drawImage(clipRect().topLeft(), scaledImage);
+		}
+		else
+		{
+			if (directBlit.loadAcquire() && pixmapRevision != imageRevision.loadAcquire())
+			{
+				//append writes the pixels under the read lock
+				readWriteLock->lockForWrite();
+				convertPixmap();
+				readWriteLock->unlock();
+			}
+
+			setupScaledPixmap(rect);
+			painter->drawPixmap(clipRect().topLeft(), mScaledPixmap);
+		}
+
 		QPen pen = mainPen();
 		if (pen.style() != Qt::NoPen)
 		{
@@ -571,6 +866,8 @@ void WaterfallContent::draw(QCPPainter* painter)
 
 void WaterfallContent::setupScaledPixmap(QRect finalRect)
 {
+	WF_PROFILE_SCOPE(profiler, EWS_ScaledPixmap);
+
 	if (mPixmap.isNull())
 		return;
 	
@@ -629,3 +926,82 @@ void WaterfallContent::setupScaledPixmap(QRect finalRect)
 		mScaledPixmap = QPixmap();
 	mScaledPixmapInvalidated = false;
 }
+
+bool WaterfallContent::canDirectBlit() const
+{
+	return directBlit.loadAcquire() && layer() && layer()->children().size() == 1;
+}
+
+QRectF WaterfallContent::visibleImageRect(const QSize& imageSize) const
+{
+	const auto xRange = parentQtPlot->xAxis->range();
+	const auto yRange = parentQtPlot->yAxis->range();
+
+	const QCPRange xLimitRange = QCPRange(topLeft->coords().x(), bottomRight->coords().x());
+	const QCPRange yLimitRange = QCPRange(bottomRight->coords().y(), topLeft->coords().y());
+
+	const double xDelta = xLimitRange.upper - xLimitRange.lower;
+	const double yDelta = yLimitRange.upper - yLimitRange.lower;
+	if (equals(xDelta, 0.0) || equals(yDelta, 0.0)) return QRectF();
+
+	const double x = (xRange.lower - xLimitRange.lower) / xDelta * imageSize.width();
+	const double y = (yLimitRange.upper - yRange.upper) / yDelta * imageSize.height();
+	const double width = (xRange.upper - xRange.lower) / xDelta * imageSize.width();
+	const double height = (yRange.upper - yRange.lower) / yDelta * imageSize.height();
+
+	return QRectF(x, y, width, height);
+}
+
+bool WaterfallContent::setupScaledImage()
+{
+	WF_PROFILE_SCOPE(profiler, EWS_ScaledPixmap);
+
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+	const double devicePixelRatio = parentQtPlot->bufferDevicePixelRatio();
+#else
+	const double devicePixelRatio = 1.0;
+#endif
+
+	const QSize targetSize = clipRect().size() * devicePixelRatio;
+	if (targetSize.isEmpty()) return false;
+
+	//append writes the pixels under the read lock, the scale must not see a half written row
+	//or a buffer detached by a snapshot
+	readWriteLock->lockForWrite();
+
+	const QImage* image = waterfallLayer->image;
+	const QRectF source = visibleImageRect(image->size());
+	const int revision = imageRevision.loadAcquire();
+
+	//zero or negative deltas leave nothing visible, scaleWaterfallImage would not write the image
+	if (source.width() <= 0.0 || source.height() <= 0.0)
+	{
+		readWriteLock->unlock();
+		return false;
+	}
+
+	if (scaledImage.size() != targetSize || scaledImage.format() != image->format())
+	{
+		scaledImage = QImage(targetSize, image->format());
+		scaledImage.fill(Qt::transparent);
+		scaledImageRevision = -1;
+	}
+
+	if (scaledImageRevision != revision || scaledImageSource != source)
+	{
+		scaleWaterfallImage(image->constBits(), image->width(), image->height(), image->bytesPerLine(),
+			source.x(), source.y(), source.width(), source.height(),
+			scaledImage.bits(), scaledImage.width(), scaledImage.height(), scaledImage.bytesPerLine());
+
+		scaledImageRevision = revision;
+		scaledImageSource = source;
+	}
+
+	readWriteLock->unlock();
+
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+	scaledImage.setDevicePixelRatio(devicePixelRatio);
+#endif
+
+	return true;
+}
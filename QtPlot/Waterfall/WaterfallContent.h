@@ -4,11 +4,16 @@
 #include "QCustomPlot/QCustomPlot.h"
 
 #include "Interval.h"
+#include "ColorMap/WfColorMap.h"
 #include "Library/QtPlotEnumLibrary.h"
+#include "WaterfallProfiler.h"
+#include "WaterfallSnapshot.h"
 
 class QCustomPlot;
-class WfColorMap;
 class WaterfallLayer;
+class WaterfallAccumulator;
+class WaterfallAutoLevel;
+class WaterfallResampler;
 class QtPlot;
 
 
@@ -21,15 +26,39 @@ public:
 	~WaterfallContent() override;
 
 public:
+	/*!
+	\brief Set the color map, the raw pointer overload takes ownership
+
+	The map is shared, not copied. Existing rows are recolored from the index plane,
+	the palette is built before the content is locked.
+	*/
 	void setColorMap(WfColorMap* inColorMap);
-	WfColorMap* getColorMap();
+	void setColorMap(const WfColorMapPtr& inColorMap);
+	WfColorMapPtr getColorMap() const;
 
 	void setAppendSide(EAppendSide side);
 	void updatePixmap();
 
+	/*!
+	\brief Direct blit drawing
+
+	When enabled and the waterfall is the only item on its layer, draw() scales the visible
+	part of the image straight into the layer paint buffer (nearest / box filter, no OpenGL)
+	and updatePixmap() no longer converts the image to QPixmap on every append.
+	*/
+	void setDirectBlit(bool enable);
+	bool getDirectBlit() const;
+
 public slots:
 	void update();
 
+signals:
+	void autoLevelChanged(const QtInterval& interval);
+
+	//emitted after the content is unlocked, possibly from the thread which changed it
+	void intervalChanged();
+	void colorMapChanged();
+
 public:
 	virtual void setResolution(int width, int height);
 	QRect getResolution() const;
@@ -38,7 +67,9 @@ public:
 	void setHeight(int height);
 	void setFillColor(const QColor& fillColor);
 
-	virtual void setInterval(int minval, int maxval);
+	void setInterval(int minval, int maxval);
+	//bounds in the transformed unit of the color map, not rounded
+	virtual void setInterval(const QtInterval& interval);
 	QtInterval getInterval() const;
 
 	void setPositionX(int minx, int maxx);
@@ -47,11 +78,55 @@ public:
 
 	virtual void clear();
 
+	/*!
+	\brief Snapshot of the content
+
+	The value history is shared row by row, appends copy no values of it.
+	The image is copied while the content is locked, which costs about one append.
+	*/
+	WaterfallSnapshot snapshot() const;
+
+	void setAccumulatorEnabled(EWaterfallTrace trace, bool enable);
+	void setAverageFactor(double alpha);
+	void resetAccumulators();
+	QVector<double> getAccumulatorTrace(EWaterfallTrace trace) const;
+
+	/*!
+	\brief Select how rows wider than the image are mapped to the image width
+	*/
+	void setResampleMode(EResampleMode mode);
+	EResampleMode getResampleMode() const;
+
+	/*!
+	\brief Select which row is colorized into the image: raw data or one of the persistence planes
+	*/
+	void setDisplayTrace(EWaterfallTrace trace);
+	EWaterfallTrace getDisplayTrace() const;
+
+	/*!
+	\brief Automatic level control
+
+	The interval follows streaming percentile estimates of the appended rows.
+	Percentiles are taken on the raw values and mapped through the color map transform.
+	*/
+	void setAutoLevelEnabled(bool enable);
+	bool getAutoLevelEnabled() const;
+	void setAutoLevelPercentiles(double low, double high);
+	void setAutoLevelWindow(int rows);
+	void setAutoLevelHysteresis(double fraction);
+	void setAutoLevelMinimumInterval(int msec);
+
+#ifdef QTPLOT_WATERFALL_PROFILING
+	inline WaterfallProfiler& getProfiler() { return profiler; }
+#endif
+
 	/*!
 	\brief Append data
 
 	Data 'data' is a linear array (of doubles) of size size*h.
 
+	Rows of any width are resampled to the image width (height for left/right append side).
+
 	\param data Array of double values. Size: w.
 	\param size Width of the data block.
 	\param needUpdatePixmap Redraw after append?
@@ -85,7 +160,8 @@ public:
 	  \param maxy Maximum y value for the layer
 	  \param minval Minimum (expected) value of data
 	  \param maxval Maximum (expected) value of data
-	  \param fm Of type QImage::Format. Supported QImage::Format_ARGB32 and QImage::Format_RGB32.
+	  \param fm Of type QImage::Format. Supported QImage::Format_ARGB32_Premultiplied, QImage::Format_ARGB32 and QImage::Format_RGB32.
+	  Color maps emit premultiplied colors for QImage::Format_ARGB32_Premultiplied, which Qt draws without conversion.
 	  \param fil Fill color for the layer (QColor).
 	 */
 	bool createLayer(qint32 width, qint32 height, qreal minx, qreal miny, qreal maxx, qreal maxy, qreal minval, qreal maxval, QImage::Format fm, QColor fil);
@@ -100,7 +176,7 @@ private:
   \param w Width of the data block.
   \param h Height of the data block.
 	*/
-	void appendT(double* data, int w, int h);
+	void appendT(const double* data, int w, int h);
 
 	/*!
   \brief Append data from bottom
@@ -111,7 +187,7 @@ private:
   \param w Width of the data block.
   \param h Height of the data block.
 	*/
-	void appendB(double* data, int w, int h);
+	void appendB(const double* data, int w, int h);
 
 	/*!
   \brief Append data from left
@@ -122,7 +198,7 @@ private:
   \param w Width of the data block.
   \param h Height of the data block.
 	*/
-	void appendL(double* data, int w, int h);
+	void appendL(const double* data, int w, int h);
 
 	/*!
   \brief Append data from right
@@ -133,7 +209,7 @@ private:
   \param w Width of the data block.
   \param h Height of the data block.
 	*/
-	void appendR(double* data, int w, int h);
+	void appendR(const double* data, int w, int h);
 
 	/*!
   \brief Set Full Data Top
@@ -186,8 +262,24 @@ private:
 protected:
 	void draw(QCPPainter* painter) override;
 
+	/*!
+	\brief Called from append with the row which is going to be colorized
+	*/
+	virtual void storeRow(const double* data, int size);
+
+	/*!
+	\brief Fill the snapshot. Called with the content locked for writing.
+	*/
+	virtual void fillSnapshot(WaterfallSnapshot& snapshot) const;
+
 private:
 	void setupScaledPixmap(QRect finalRect);
+	void convertPixmap();
+
+	bool canDirectBlit() const;
+	QRectF visibleImageRect(const QSize& imageSize) const;
+	//false when there is nothing to draw
+	bool setupScaledImage();
 
 protected:
 	QRect			lastFinalRect;
@@ -199,8 +291,31 @@ protected:
 	EAppendSide		appendSide;
 	qint32			appendHeight;
 
+	WaterfallResampler*		resampler;
+	WaterfallAccumulator*	accumulator;
+	WaterfallAutoLevel*		autoLevel;
+	EWaterfallTrace			displayTrace;
+
 	QCPRange xLastRange;
 	QCPRange yLastRange;
 
+	QAtomicInt	directBlit;
+	QAtomicInt	imageRevision;
+	int			pixmapRevision = 0;
+
+	QImage		scaledImage;
+	QRectF		scaledImageSource;
+	int			scaledImageRevision = -1;
+
+	//indexes of one row for the left / right append sides
+	QVector<quint16>	rowIndexes;
+
+	//persistence plane row which is colorized, owned by the ingest thread
+	QVector<double>		displayRow;
+
+#ifdef QTPLOT_WATERFALL_PROFILING
+	WaterfallProfiler profiler;
+#endif
+
 };
 
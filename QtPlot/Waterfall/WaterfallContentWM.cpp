@@ -1,6 +1,7 @@
 #include "WaterfallContentWM.h"
 
 #include "WaterfallLayer.h"
+#include "WaterfallIndexPlane.h"
 #include "ColorMap/WfColorMap.h"
 #include "Library/QtPlotMathLibrary.h"
 
@@ -15,12 +16,12 @@ WaterfallContentWithMemory::~WaterfallContentWithMemory()
 	delete wfData;
 }
 
-void WaterfallContentWithMemory::setInterval(int minval, int maxval)
+void WaterfallContentWithMemory::setInterval(const QtInterval& interval)
 {
 	readWriteLock->lockForRead();
 	{
-		if (equals(minval, waterfallLayer->range.minValue())
-			&& equals(maxval, waterfallLayer->range.maxValue()))
+		if (equals(interval.minValue(), waterfallLayer->range.minValue())
+			&& equals(interval.maxValue(), waterfallLayer->range.maxValue()))
 		{
 			readWriteLock->unlock();
 			return;
@@ -28,22 +29,39 @@ void WaterfallContentWithMemory::setInterval(int minval, int maxval)
 	}
 	readWriteLock->unlock();
 
+	//once the ring has wrapped its rows are out of order, the indexes are recolored instead
+	if (wfData->offset() > wfData->height())
 	{
+		WaterfallContent::setInterval(interval);
+		return;
+	}
+
+	{
+		//the history is indexed again from the stored values, at full resolution for the new interval
 		readWriteLock->lockForWrite();
-		waterfallLayer->range = QtInterval(minval, maxval);
+		waterfallLayer->range = interval;
+		waterfallLayer->indexPlane->resetInterval(waterfallLayer->range);
 		readWriteLock->unlock();
 
 		// wfData->sortData();
-		WaterfallContent::setData(wfData->data(), wfData->width(), wfData->offset());
+		QVector<double> history = wfData->linear(wfData->offset());
+		WaterfallContent::setData(history.data(), wfData->width(), wfData->offset());
 	}
 	
 	update();
+
+	emit intervalChanged();
 }
 
-void WaterfallContentWithMemory::append(double* data, int size, bool needUpdatePixmap)
+void WaterfallContentWithMemory::storeRow(const double* data, int size)
 {
 	wfData->append(data, size);
-	WaterfallContent::append(data, size, needUpdatePixmap);
+}
+
+void WaterfallContentWithMemory::fillSnapshot(WaterfallSnapshot& snapshot) const
+{
+	WaterfallContent::fillSnapshot(snapshot);
+	wfData->snapshot(snapshot);
 }
 
 void WaterfallContentWithMemory::setData(double* data, int width, int height)
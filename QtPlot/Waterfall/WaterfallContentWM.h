@@ -13,14 +13,18 @@ public:
 	~WaterfallContentWithMemory() override;
 
 public:
-	void setInterval(int minval, int maxval) override;
-	void append(double* data, int size, bool needUpdatePixmap) override;
+	using WaterfallContent::setInterval;
+	void setInterval(const QtInterval& interval) override;
 	void setData(double* data, int width, int height) override;
 
 	void setResolution(int width, int height) override;
 
 	void clear() override;
 
+protected:
+	void storeRow(const double* data, int size) override;
+	void fillSnapshot(WaterfallSnapshot& snapshot) const override;
+
 private:
 	WaterfallData* wfData;
 		
@@ -30,13 +34,17 @@ class WaterfallData
 {
 
 public:
-	void append(double* data, int width)
+	void append(const double* data, int width)
 	{
 		int currentOffset = _offset;
 		if (_offset >= _height) currentOffset = _offset % _height;
 
 		_dataIndexes[currentOffset] = _offset;
-		std::memcpy(_data + (currentOffset * _width), data, sizeof(double) * _width);
+
+		//a row still referenced by a snapshot is replaced, the snapshot keeps the old one
+		QVector<double>& row = _rows[currentOffset];
+		if (!row.isDetached()) row = QVector<double>(_width);
+		std::memcpy(row.data(), data, sizeof(double) * _width);
 
 		_offset++;
 		_bIsSort = false;
@@ -47,12 +55,8 @@ public:
 		_width = inWidth;
 		_height = inHeight;
 
-		delete _data;
-		_data = new double[_width * _height];
-		std::fill_n(_data, _width * _height, -10000);
-
-		delete _data_temp;
-		_data_temp = new double[_width];
+		//the rows share one buffer until they are written
+		_rows.fill(QVector<double>(_width, -10000), _height);
 
 		delete _dataIndexes;
 		_dataIndexes = new int[_height];
@@ -63,7 +67,7 @@ public:
 
 	void clear()
 	{
-		std::fill_n(_data, _width * _height, -10000);
+		_rows.fill(QVector<double>(_width, -10000));
 		std::fill_n(_dataIndexes, _height, -1);
 		_offset = 0;
 	}
@@ -71,7 +75,16 @@ public:
 	void setData(double* data, int inWidth, int inHeight)
 	{
 		clear();
-		std::memcpy(_data, data, sizeof(double) * inWidth * inHeight);
+
+		const int rows = qMin(inHeight, _height);
+		const int width = qMin(inWidth, _width);
+		for (int y = 0; y < rows; y++)
+		{
+			QVector<double> row(_width, -10000);
+			std::memcpy(row.data(), data + static_cast<qint64>(y) * inWidth, sizeof(double) * width);
+			_rows[y] = row;
+		}
+
 		_offset = inHeight;
 		_bIsSort = true;
 	}
@@ -85,7 +98,29 @@ public:
 		_bIsSort = true;
 	}
 
-	inline double* data() const { return _data; }
+	//the first 'count' rows of the ring, one after the other
+	QVector<double> linear(int count) const
+	{
+		count = qBound(0, count, _height);
+
+		QVector<double> result(count * _width);
+		for (int y = 0; y < count; y++)
+		{
+			std::memcpy(result.data() + static_cast<qint64>(y) * _width, _rows.at(y).constData(), sizeof(double) * _width);
+		}
+
+		return result;
+	}
+
+	void snapshot(WaterfallSnapshot& snapshot) const
+	{
+		//the rows are shared, append replaces a shared row instead of writing into it
+		snapshot.ring = _rows;
+		snapshot.width = _width;
+		snapshot.ringRows = _height;
+		snapshot.rowCount = qMin(_offset, _height);
+		snapshot.firstRow = _offset >= _height && _height > 0 ? _offset % _height : 0;
+	}
 
 	inline int width() const { return _width; }
 	inline int height() const { return _height; }
@@ -129,14 +164,11 @@ private:
 		arr[pos1] = arr[pos2];
 		arr[pos2] = temp;
 
-		memcpy(_data_temp, _data + pos1 * _width, sizeof(double) * _width);
-		memcpy(_data + pos1 * _width, _data + pos2 * _width, sizeof(double) * _width);
-		memcpy(_data + pos2 * _width, _data_temp, sizeof(double) * _width);
+		_rows[pos1].swap(_rows[pos2]);
 	}
 
 private:
-	double* _data = nullptr;
-	double* _data_temp = nullptr;
+	QVector<QVector<double>> _rows;
 	int* _dataIndexes = nullptr;
 	
 	int _offset = 0;
@@ -0,0 +1,102 @@
+#include "WaterfallExporter.h"
+
+#include <QDebug>
+#include <QFile>
+
+
+WaterfallExporter::WaterfallExporter(const WaterfallSnapshot& inSnapshot, const QString& inFileName, EExportFormat inFormat)
+	: snapshot(inSnapshot),
+	fileName(inFileName),
+	format(inFormat)
+{
+	setAutoDelete(false);
+	connect(this, &WaterfallExporter::finished, this, &QObject::deleteLater);
+}
+
+void WaterfallExporter::run()
+{
+	const bool success = exportSnapshot(snapshot, fileName, format);
+
+	//release the shared buffers before the content writes into them again
+	snapshot = WaterfallSnapshot();
+
+	emit finished(fileName, success);
+}
+
+bool WaterfallExporter::exportSnapshot(const WaterfallSnapshot& snapshot, const QString& fileName, EExportFormat format)
+{
+	switch (format)
+	{
+	case EEF_Png:
+		return !snapshot.image.isNull() && snapshot.image.save(fileName, "PNG");
+
+	case EEF_RawFloat:
+		return exportData(snapshot, fileName, false);
+
+	case EEF_Npy:
+		return exportData(snapshot, fileName, true);
+	}
+
+	return false;
+}
+
+bool WaterfallExporter::exportData(const WaterfallSnapshot& snapshot, const QString& fileName, bool withNpyHeader)
+{
+	if (!snapshot.hasData())
+	{
+		qDebug() << "Waterfall export error: no value history in snapshot" << fileName;
+		return false;
+	}
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qDebug() << "Waterfall export error: can't open" << fileName;
+		return false;
+	}
+
+	if (withNpyHeader)
+	{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		const char* descr = "<f4";
+#else
+		const char* descr = ">f4";
+#endif
+		QByteArray header = QString("{'descr': '%1', 'fortran_order': False, 'shape': (%2, %3), }")
+			.arg(descr).arg(snapshot.rowCount).arg(snapshot.width).toLatin1();
+
+		//magic(6) + version(2) + length(2) + header must be aligned to 64 bytes and end with '\n'
+		const int preambleSize = 10;
+		const int padding = 64 - (preambleSize + header.size() + 1) % 64;
+		header.append(QByteArray(padding % 64, ' '));
+		header.append('\n');
+
+		const quint16 headerSize = static_cast<quint16>(header.size());
+		const char preamble[preambleSize] = {
+			'\x93', 'N', 'U', 'M', 'P', 'Y', '\x01', '\x00',
+			static_cast<char>(headerSize & 0xff), static_cast<char>(headerSize >> 8)
+		};
+
+		file.write(preamble, preambleSize);
+		file.write(header);
+	}
+
+	QVector<float> line(snapshot.width);
+	for (int index = 0; index < snapshot.rowCount; index++)
+	{
+		const double* row = snapshot.row(index);
+		for (int x = 0; x < snapshot.width; x++)
+		{
+			line[x] = static_cast<float>(row[x]);
+		}
+
+		const qint64 size = static_cast<qint64>(sizeof(float)) * snapshot.width;
+		if (file.write(reinterpret_cast<const char*>(line.constData()), size) != size)
+		{
+			qDebug() << "Waterfall export error: write failed" << fileName;
+			return false;
+		}
+	}
+
+	return true;
+}
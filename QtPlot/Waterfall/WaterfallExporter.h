@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+
+#include "WaterfallSnapshot.h"
+#include "Library/QtPlotEnumLibrary.h"
+
+
+/*!
+\brief Background export of a waterfall snapshot
+
+PNG stores the image, raw float and NPY store the value history as float32 rows
+(oldest first). Raw float uses the host byte order.
+*/
+class WaterfallExporter : public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+	WaterfallExporter(const WaterfallSnapshot& snapshot, const QString& fileName, EExportFormat format);
+
+	void run() override;
+
+	static bool exportSnapshot(const WaterfallSnapshot& snapshot, const QString& fileName, EExportFormat format);
+
+signals:
+	void finished(const QString& fileName, bool success);
+
+private:
+	static bool exportData(const WaterfallSnapshot& snapshot, const QString& fileName, bool withNpyHeader);
+
+private:
+	WaterfallSnapshot	snapshot;
+	QString				fileName;
+	EExportFormat		format;
+
+};
@@ -0,0 +1,238 @@
+#include "WaterfallIndexPlane.h"
+
+#include "ColorMap/WfColorMap.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+WaterfallIndexPlane::WaterfallIndexPlane()
+	: palette(Levels + 1, 0u),
+	lookup(Levels + 1, 0u),
+	display(0.0, 0.0),
+	quantization(0.0, 0.0)
+{
+}
+
+void WaterfallIndexPlane::resize(int width, int height)
+{
+	planeWidth = qMax(0, width);
+	planeHeight = qMax(0, height);
+
+	indices.resize(planeWidth * planeHeight);
+	clear();
+}
+
+void WaterfallIndexPlane::clear()
+{
+	indices.fill(EmptyIndex);
+	resetInterval(display);
+}
+
+QtInterval WaterfallIndexPlane::quantizationFor(const QtInterval& interval)
+{
+	const double margin = interval.width() / 2.0;
+
+	return QtInterval(interval.minValue() - margin, interval.maxValue() + margin);
+}
+
+void WaterfallIndexPlane::setDisplayInterval(const QtInterval& interval)
+{
+	display = interval;
+
+	if (quantization.width() <= 0.0)
+	{
+		quantization = quantizationFor(display);
+	}
+	else if (display.width() > 0.0)
+	{
+		const double maxWidth = display.width() * MaxQuantizationRatio;
+		const bool covered = display.minValue() >= quantization.minValue() && display.maxValue() <= quantization.maxValue();
+
+		if (!covered || quantization.width() > maxWidth)
+		{
+			//grow while the levels stay dense enough, otherwise start over around the displayed interval
+			const QtInterval grown = quantization | quantizationFor(display);
+			remap(grown.width() <= maxWidth ? grown : quantizationFor(display));
+		}
+	}
+
+	updateLookup();
+}
+
+void WaterfallIndexPlane::resetInterval(const QtInterval& interval)
+{
+	display = interval;
+	quantization = quantizationFor(display);
+
+	updateLookup();
+}
+
+void WaterfallIndexPlane::scrollRows(int rows)
+{
+	if (rows == 0 || qAbs(rows) >= planeHeight) return;
+
+	quint16* data = indices.data();
+	const int moved = (planeHeight - qAbs(rows)) * planeWidth;
+
+	if (rows > 0)
+	{
+		std::memmove(data + rows * planeWidth, data, moved * sizeof(quint16));
+	}
+	else
+	{
+		std::memmove(data, data - rows * planeWidth, moved * sizeof(quint16));
+	}
+}
+
+void WaterfallIndexPlane::scrollColumns(int columns)
+{
+	if (columns == 0 || qAbs(columns) >= planeWidth) return;
+
+	const int moved = planeWidth - qAbs(columns);
+
+	for (int y = 0; y < planeHeight; y++)
+	{
+		quint16* line = scanLine(y);
+
+		if (columns > 0)
+		{
+			std::memmove(line + columns, line, moved * sizeof(quint16));
+		}
+		else
+		{
+			std::memmove(line, line - columns, moved * sizeof(quint16));
+		}
+	}
+}
+
+QVector<QRgb> WaterfallIndexPlane::makePalette(const WfColorMap* colorMap, const QColor& fillColor, QImage::Format format)
+{
+	QVector<QRgb> colors(Levels + 1, 0u);
+
+	const bool premultipliedFormat = format == QImage::Format_ARGB32_Premultiplied;
+
+	if (colorMap != nullptr)
+	{
+		colorMap->palette(colors.data(), Levels);
+
+		//shared maps are immutable, convert here when the map was configured for the other format
+		if (premultipliedFormat && !colorMap->isPremultiplied())
+		{
+			for (int i = 0; i < Levels; i++)
+				colors[i] = qPremultiply(colors[i]);
+		}
+		else if (!premultipliedFormat && colorMap->isPremultiplied())
+		{
+			for (int i = 0; i < Levels; i++)
+				colors[i] = qUnpremultiply(colors[i]);
+		}
+	}
+
+	QRgb fill = fillColor.rgba();
+	if (premultipliedFormat)
+	{
+		fill = qPremultiply(fill);
+	}
+	else if (format == QImage::Format_RGB32)
+	{
+		fill |= 0xff000000u;
+	}
+
+	colors[EmptyIndex] = fill;
+
+	return colors;
+}
+
+void WaterfallIndexPlane::setPalette(const QVector<QRgb>& colors)
+{
+	if (colors.size() != Levels + 1) return;
+
+	palette = colors;
+	updateLookup();
+}
+
+void WaterfallIndexPlane::remap(const QtInterval& to)
+{
+	//index i is at quantization.min + i / (Levels - 1) * quantization.width, clamped to the ends of 'to'
+	quint16 table[Levels + 1];
+
+	const double maxIndex = Levels - 1;
+	const double scale = quantization.width() / to.width();
+	const double offset = (quantization.minValue() - to.minValue()) / to.width() * maxIndex + 0.5;
+
+	for (int i = 0; i < Levels; i++)
+	{
+		const double index = qBound(0.0, i * scale + offset, maxIndex);
+		table[i] = static_cast<quint16>(index);
+	}
+	table[EmptyIndex] = EmptyIndex;
+
+	quint16* data = indices.data();
+	const int count = indices.size();
+	for (int i = 0; i < count; i++)
+	{
+		data[i] = table[data[i]];
+	}
+
+	quantization = to;
+}
+
+void WaterfallIndexPlane::updateLookup()
+{
+	QRgb* table = lookup.data();
+	const QRgb* colors = palette.constData();
+
+	const double maxIndex = Levels - 1;
+	if (display.width() <= 0.0 || quantization.width() <= 0.0)
+	{
+		std::fill_n(table, int(Levels), colors[0]);
+	}
+	else
+	{
+		//quantization index -> value -> displayed index, clamped to the ends of the palette
+		const double scale = quantization.width() / display.width();
+		const double offset = (quantization.minValue() - display.minValue()) / display.width() * maxIndex + 0.5;
+
+		for (int i = 0; i < Levels; i++)
+		{
+			const double index = qBound(0.0, i * scale + offset, maxIndex);
+			table[i] = colors[static_cast<int>(index)];
+		}
+	}
+	table[EmptyIndex] = colors[EmptyIndex];
+}
+
+void WaterfallIndexPlane::colorize(const quint16* source, QRgb* colors, int count) const
+{
+	const QRgb* table = lookup.constData();
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		colors[i] = table[source[i]];
+		colors[i + 1] = table[source[i + 1]];
+		colors[i + 2] = table[source[i + 2]];
+		colors[i + 3] = table[source[i + 3]];
+	}
+
+	for (; i < count; i++)
+	{
+		colors[i] = table[source[i]];
+	}
+}
+
+void WaterfallIndexPlane::colorizeRow(int y, QImage* image) const
+{
+	if (y < 0 || y >= planeHeight || y >= image->height()) return;
+
+	colorize(constScanLine(y), reinterpret_cast<QRgb*>(image->scanLine(y)), qMin(planeWidth, image->width()));
+}
+
+void WaterfallIndexPlane::colorize(QImage* image) const
+{
+	for (int y = 0; y < planeHeight; y++)
+	{
+		colorizeRow(y, image);
+	}
+}
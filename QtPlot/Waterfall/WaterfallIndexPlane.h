@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+#include "Interval.h"
+
+class WfColorMap;
+
+
+/*!
+\brief Quantized values of the waterfall image
+
+Every pixel keeps its color index (Levels steps over the quantization interval, EmptyIndex for the fill color).
+The image is produced by a palette lookup, so a color map change and an interval change are one pass
+over the plane, without going back through the colors.
+
+The indexes are quantized against their own interval, not the displayed one: it covers the
+displayed interval plus half its width on each side. Changing the displayed interval within it
+only rebuilds the lookup table, so small adjustments don't rewrite the indexes. The quantization
+interval is remapped when the displayed one leaves it (grown to cover both) or when the displayed
+one shrinks below a quarter of it (quantized again around the displayed one, so the levels stay
+dense where they are shown). Remapping to a narrower interval clamps the values outside of it,
+they are not recovered when the displayed interval widens again. clear() starts over from the
+displayed interval.
+*/
+class WaterfallIndexPlane
+{
+public:
+	enum
+	{
+		Levels = 4096,
+		EmptyIndex = Levels,
+		MaxQuantizationRatio = 4
+	};
+
+	WaterfallIndexPlane();
+
+	void resize(int width, int height);
+	void clear();
+
+	/*!
+	\brief Interval (in the transformed unit) the indexes are quantized against, pass it to WfColorMap::indexRow
+	*/
+	inline const QtInterval& interval() const { return quantization; }
+
+	/*!
+	\brief Set the displayed interval (in the transformed unit)
+
+	Remaps the indexes when the quantization interval doesn't cover the new one or is more than
+	MaxQuantizationRatio times as wide.
+	*/
+	void setDisplayInterval(const QtInterval& interval);
+
+	/*!
+	\brief Set the displayed interval and quantize against it from now on, the stored indexes are left as they are
+
+	For callers which write every row again afterwards.
+	*/
+	void resetInterval(const QtInterval& interval);
+
+	inline int width() const { return planeWidth; }
+	inline int height() const { return planeHeight; }
+
+	inline quint16* scanLine(int y) { return indices.data() + y * planeWidth; }
+	inline const quint16* constScanLine(int y) const { return indices.constData() + y * planeWidth; }
+
+	/*!
+	\brief Shift the rows down (rows > 0) or up (rows < 0), the free rows are not initialized
+	*/
+	void scrollRows(int rows);
+
+	/*!
+	\brief Shift every row right (columns > 0) or left (columns < 0), the free columns are not initialized
+	*/
+	void scrollColumns(int columns);
+
+	/*!
+	\brief Palette of a color map and fill color, converted to the image format
+
+	Does not touch the plane, can be built without holding the content lock.
+	*/
+	static QVector<QRgb> makePalette(const WfColorMap* colorMap, const QColor& fillColor, QImage::Format format);
+	void setPalette(const QVector<QRgb>& colors);
+
+	void colorize(const quint16* source, QRgb* colors, int count) const;
+	void colorizeRow(int y, QImage* image) const;
+	void colorize(QImage* image) const;
+
+private:
+	static QtInterval quantizationFor(const QtInterval& interval);
+
+	//move the indexes to another quantization interval, values outside of it are clamped
+	void remap(const QtInterval& to);
+	void updateLookup();
+
+private:
+	QVector<quint16>	indices;
+	QVector<QRgb>		palette;
+	//palette seen through the quantization and the displayed interval
+	QVector<QRgb>		lookup;
+
+	QtInterval	display;
+	QtInterval	quantization;
+
+	int	planeWidth = 0;
+	int	planeHeight = 0;
+
+};
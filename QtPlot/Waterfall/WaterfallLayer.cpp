@@ -1,17 +1,18 @@
 #include "WaterfallLayer.h"
 
 #include "ColorMap/WfColorMap.h"
+#include "WaterfallIndexPlane.h"
 
 WaterfallLayer::WaterfallLayer()
 {
 	image = nullptr;
-	colorMap = nullptr;
+	indexPlane = new WaterfallIndexPlane();
 	fillColor = Qt::white;
 	range = QtInterval(0, 0);
 }
 
 WaterfallLayer::~WaterfallLayer()
 {
-	delete colorMap;
 	delete image;
+	delete indexPlane;
 }
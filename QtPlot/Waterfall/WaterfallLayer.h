@@ -4,9 +4,10 @@
 #include <QObject>
 
 #include "Interval.h"
+#include "ColorMap/WfColorMap.h"
 
 
-class WfColorMap;
+class WaterfallIndexPlane;
 
 
 class QTPLOT_EXPORT WaterfallLayer : public QObject
@@ -22,6 +23,9 @@ public:
 	QImage::Format	format;
 	QColor			fillColor;
 	QtInterval		range;
-	WfColorMap*		colorMap;
+	WfColorMapPtr	colorMap;
+
+	//color indexes of the image pixels
+	WaterfallIndexPlane*	indexPlane;
 
 };
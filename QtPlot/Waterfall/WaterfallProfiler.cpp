@@ -0,0 +1,113 @@
+#include "WaterfallProfiler.h"
+
+
+namespace
+{
+	//latencyStatisticsUpdated may be connected across threads
+	static const struct RegisterLatencyHistogram
+	{
+		inline RegisterLatencyHistogram()
+		{
+			qRegisterMetaType<WaterfallLatencyHistogram>();
+			qRegisterMetaType<QVector<WaterfallLatencyHistogram>>();
+		}
+	} registerLatencyHistogram;
+}
+
+double WaterfallLatencyHistogram::meanUs() const
+{
+	if (count == 0) return 0.0;
+
+	return totalNs / 1000.0 / count;
+}
+
+double WaterfallLatencyHistogram::percentileUs(double percentile) const
+{
+	if (count == 0 || buckets.isEmpty()) return 0.0;
+
+	const quint64 rank = static_cast<quint64>(qBound(0.0, percentile, 1.0) * (count - 1));
+
+	quint64 seen = 0;
+	for (int i = 0; i < buckets.size(); i++)
+	{
+		seen += buckets[i];
+		if (seen > rank)
+		{
+			//upper bound of the bucket
+			return i == 0 ? 1.0 : static_cast<double>(quint64(1) << i);
+		}
+	}
+
+	return maxNs / 1000.0;
+}
+
+WaterfallProfiler::WaterfallProfiler()
+{
+	reset();
+}
+
+void WaterfallProfiler::record(EWaterfallStage stage, qint64 ns)
+{
+	if (stage < 0 || stage >= EWS_Count) return;
+
+	qint64 us = ns / 1000;
+	int bucket = 0;
+	while (us > 0 && bucket < BucketCount - 1)
+	{
+		us >>= 1;
+		bucket++;
+	}
+
+	buckets[stage][bucket].fetchAndAddRelaxed(1);
+	counts[stage].fetchAndAddRelaxed(1);
+	totals[stage].fetchAndAddRelaxed(ns);
+
+	qint64 currentMax = maximums[stage].loadAcquire();
+	while (ns > currentMax && !maximums[stage].testAndSetOrdered(currentMax, ns, currentMax))
+	{
+	}
+}
+
+void WaterfallProfiler::reset()
+{
+	for (int stage = 0; stage < EWS_Count; stage++)
+	{
+		for (int bucket = 0; bucket < BucketCount; bucket++)
+		{
+			buckets[stage][bucket].storeRelease(0);
+		}
+
+		counts[stage].storeRelease(0);
+		totals[stage].storeRelease(0);
+		maximums[stage].storeRelease(0);
+	}
+}
+
+WaterfallLatencyHistogram WaterfallProfiler::histogram(EWaterfallStage stage) const
+{
+	WaterfallLatencyHistogram result;
+	if (stage < 0 || stage >= EWS_Count) return result;
+
+	result.buckets.resize(BucketCount);
+	for (int bucket = 0; bucket < BucketCount; bucket++)
+	{
+		result.buckets[bucket] = buckets[stage][bucket].loadAcquire();
+	}
+
+	result.count = counts[stage].loadAcquire();
+	result.totalNs = totals[stage].loadAcquire();
+	result.maxNs = maximums[stage].loadAcquire();
+
+	return result;
+}
+
+QVector<WaterfallLatencyHistogram> WaterfallProfiler::histograms() const
+{
+	QVector<WaterfallLatencyHistogram> result(EWS_Count);
+	for (int stage = 0; stage < EWS_Count; stage++)
+	{
+		result[stage] = histogram(static_cast<EWaterfallStage>(stage));
+	}
+
+	return result;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QVector>
+
+#include "QtPlotGlobal.h"
+#include "Library/QtPlotEnumLibrary.h"
+
+
+/*!
+\brief Latency histogram of one waterfall pipeline stage
+
+Bucket i holds the number of samples whose duration was in [2^(i-1), 2^i) microseconds,
+bucket 0 holds everything below one microsecond.
+*/
+struct QTPLOT_EXPORT WaterfallLatencyHistogram
+{
+	QVector<quint64> buckets;
+	quint64 count = 0;
+	qint64 totalNs = 0;
+	qint64 maxNs = 0;
+
+	double meanUs() const;
+	double percentileUs(double percentile) const;
+};
+
+Q_DECLARE_METATYPE(WaterfallLatencyHistogram)
+
+
+class QTPLOT_EXPORT WaterfallProfiler
+{
+public:
+	enum { BucketCount = 32 };
+
+	WaterfallProfiler();
+
+	void record(EWaterfallStage stage, qint64 ns);
+	void reset();
+
+	WaterfallLatencyHistogram histogram(EWaterfallStage stage) const;
+	QVector<WaterfallLatencyHistogram> histograms() const;
+
+private:
+	Q_DISABLE_COPY(WaterfallProfiler)
+
+	QAtomicInteger<quint64> buckets[EWS_Count][BucketCount];
+	QAtomicInteger<quint64> counts[EWS_Count];
+	QAtomicInteger<qint64>	totals[EWS_Count];
+	QAtomicInteger<qint64>	maximums[EWS_Count];
+};
+
+
+class WaterfallProfileScope
+{
+public:
+	WaterfallProfileScope(WaterfallProfiler& inProfiler, EWaterfallStage inStage)
+		: profiler(inProfiler), stage(inStage)
+	{
+		timer.start();
+	}
+
+	~WaterfallProfileScope()
+	{
+		profiler.record(stage, timer.nsecsElapsed());
+	}
+
+private:
+	WaterfallProfiler&	profiler;
+	EWaterfallStage		stage;
+	QElapsedTimer		timer;
+};
+
+
+/*
+	Instrumentation points. Define QTPLOT_WATERFALL_PROFILING to enable them,
+	otherwise every macro expands to nothing.
+*/
+#ifdef QTPLOT_WATERFALL_PROFILING
+# define WF_PROFILE_CONCAT_IMPL(a, b) a##b
+# define WF_PROFILE_CONCAT(a, b) WF_PROFILE_CONCAT_IMPL(a, b)
+# define WF_PROFILE_SCOPE(profiler, stage) \
+	WaterfallProfileScope WF_PROFILE_CONCAT(wfProfileScope, __LINE__)(profiler, stage)
+# define WF_PROFILE_RECORD(profiler, stage, ns) (profiler).record(stage, ns)
+# define WF_PROFILE_TIMER_START(timer) (timer).start()
+#else
+# define WF_PROFILE_SCOPE(profiler, stage)
+# define WF_PROFILE_RECORD(profiler, stage, ns)
+# define WF_PROFILE_TIMER_START(timer)
+#endif
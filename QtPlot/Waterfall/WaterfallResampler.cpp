@@ -0,0 +1,155 @@
+#include "WaterfallResampler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define WF_RESAMPLER_SSE2
+# include <emmintrin.h>
+#endif
+
+
+namespace
+{
+	inline double reduceMax(const double* data, int n)
+	{
+		int i = 0;
+		double result = data[0];
+
+#ifdef WF_RESAMPLER_SSE2
+		if (n >= 4)
+		{
+			__m128d acc0 = _mm_loadu_pd(data);
+			__m128d acc1 = _mm_loadu_pd(data + 2);
+			for (i = 4; i + 4 <= n; i += 4)
+			{
+				acc0 = _mm_max_pd(acc0, _mm_loadu_pd(data + i));
+				acc1 = _mm_max_pd(acc1, _mm_loadu_pd(data + i + 2));
+			}
+			acc0 = _mm_max_pd(acc0, acc1);
+			acc0 = _mm_max_sd(acc0, _mm_unpackhi_pd(acc0, acc0));
+			result = _mm_cvtsd_f64(acc0);
+		}
+#endif
+
+		for (; i < n; i++)
+			result = data[i] > result ? data[i] : result;
+
+		return result;
+	}
+
+	inline double reduceMin(const double* data, int n)
+	{
+		int i = 0;
+		double result = data[0];
+
+#ifdef WF_RESAMPLER_SSE2
+		if (n >= 4)
+		{
+			__m128d acc0 = _mm_loadu_pd(data);
+			__m128d acc1 = _mm_loadu_pd(data + 2);
+			for (i = 4; i + 4 <= n; i += 4)
+			{
+				acc0 = _mm_min_pd(acc0, _mm_loadu_pd(data + i));
+				acc1 = _mm_min_pd(acc1, _mm_loadu_pd(data + i + 2));
+			}
+			acc0 = _mm_min_pd(acc0, acc1);
+			acc0 = _mm_min_sd(acc0, _mm_unpackhi_pd(acc0, acc0));
+			result = _mm_cvtsd_f64(acc0);
+		}
+#endif
+
+		for (; i < n; i++)
+			result = data[i] < result ? data[i] : result;
+
+		return result;
+	}
+
+	inline double reduceMean(const double* data, int n)
+	{
+		int i = 0;
+		double sum = 0.0;
+
+#ifdef WF_RESAMPLER_SSE2
+		if (n >= 4)
+		{
+			__m128d acc0 = _mm_setzero_pd();
+			__m128d acc1 = _mm_setzero_pd();
+			for (; i + 4 <= n; i += 4)
+			{
+				acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+				acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+			}
+			acc0 = _mm_add_pd(acc0, acc1);
+			acc0 = _mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0));
+			sum = _mm_cvtsd_f64(acc0);
+		}
+#endif
+
+		for (; i < n; i++)
+			sum += data[i];
+
+		return sum / n;
+	}
+}
+
+
+const double* WaterfallResampler::resample(const double* data, int size, int target)
+{
+	if (size == target || size <= 0 || target <= 0) return data;
+
+	if (buffer.size() != target)
+	{
+		buffer.resize(target);
+	}
+
+	if (size > target)
+	{
+		reduce(data, size, target);
+	}
+	else
+	{
+		stretch(data, size, target);
+	}
+
+	return buffer.constData();
+}
+
+void WaterfallResampler::reduce(const double* data, int size, int target)
+{
+	double* out = buffer.data();
+
+	for (int x = 0; x < target; x++)
+	{
+		//bins [begin, end) belong to the pixel x
+		const int begin = static_cast<int>(static_cast<qint64>(x) * size / target);
+		const int end = static_cast<int>(static_cast<qint64>(x + 1) * size / target);
+		const int count = end - begin;
+
+		switch (mode)
+		{
+		case ERM_Max:
+			out[x] = reduceMax(data + begin, count);
+			break;
+
+		case ERM_Mean:
+			out[x] = reduceMean(data + begin, count);
+			break;
+
+		case ERM_Min:
+			out[x] = reduceMin(data + begin, count);
+			break;
+
+		case ERM_Decimate:
+			out[x] = data[begin];
+			break;
+		}
+	}
+}
+
+void WaterfallResampler::stretch(const double* data, int size, int target)
+{
+	double* out = buffer.data();
+
+	for (int x = 0; x < target; x++)
+	{
+		out[x] = data[static_cast<qint64>(x) * size / target];
+	}
+}
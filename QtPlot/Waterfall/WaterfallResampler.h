@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QVector>
+
+#include "Library/QtPlotEnumLibrary.h"
+
+
+/*!
+\brief Horizontal resampler stage of the waterfall
+
+Maps a row of N bins to the image width before colorization.
+N > width: every pixel gets the max / mean / min / first of its bins.
+N < width: every pixel gets the nearest bin.
+*/
+class WaterfallResampler
+{
+public:
+	inline void setMode(EResampleMode inMode) { mode = inMode; }
+	inline EResampleMode getMode() const { return mode; }
+
+	/*!
+	\brief Resample a row
+
+	\param data Array of double values. Size: size.
+	\param size Width of the row.
+	\param target Width of the result.
+	\return 'data' when size == target, otherwise an internal buffer of 'target' values
+	valid until the next call.
+	*/
+	const double* resample(const double* data, int size, int target);
+
+private:
+	void reduce(const double* data, int size, int target);
+	void stretch(const double* data, int size, int target);
+
+private:
+	EResampleMode	mode = ERM_Max;
+	QVector<double>	buffer;
+
+};
@@ -0,0 +1,120 @@
+#include "WaterfallScaler.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+namespace
+{
+	inline bool isInteger(double value, int& result)
+	{
+		result = static_cast<int>(std::lround(value));
+		return std::fabs(value - result) < 1e-6;
+	}
+
+	void scaleBox(const uchar* src, int srcStride, int x0, int y0, int kx, int ky,
+		uchar* dst, int dstWidth, int dstHeight, int dstStride)
+	{
+		const quint32 count = static_cast<quint32>(kx * ky);
+		const quint32 round = count / 2;
+
+		for (int dy = 0; dy < dstHeight; dy++)
+		{
+			quint32* out = reinterpret_cast<quint32*>(dst + dy * dstStride);
+			const uchar* rows = src + (y0 + dy * ky) * srcStride;
+
+			for (int dx = 0; dx < dstWidth; dx++)
+			{
+				quint32 a = 0, r = 0, g = 0, b = 0;
+				const int sx = x0 + dx * kx;
+
+				for (int j = 0; j < ky; j++)
+				{
+					const quint32* in = reinterpret_cast<const quint32*>(rows + j * srcStride) + sx;
+					for (int i = 0; i < kx; i++)
+					{
+						const quint32 p = in[i];
+						a += p >> 24;
+						r += (p >> 16) & 0xff;
+						g += (p >> 8) & 0xff;
+						b += p & 0xff;
+					}
+				}
+
+				out[dx] = (((a + round) / count) << 24) | (((r + round) / count) << 16)
+					| (((g + round) / count) << 8) | ((b + round) / count);
+			}
+		}
+	}
+
+	void scaleNearest(const uchar* src, int srcWidth, int srcHeight, int srcStride,
+		double x, double y, double width, double height,
+		uchar* dst, int dstWidth, int dstHeight, int dstStride)
+	{
+		const double scaleX = width / dstWidth;
+		const double scaleY = height / dstHeight;
+
+		std::vector<int> columns(dstWidth);
+		for (int dx = 0; dx < dstWidth; dx++)
+		{
+			const int sx = static_cast<int>(std::floor(x + (dx + 0.5) * scaleX));
+			columns[dx] = sx >= 0 && sx < srcWidth ? sx : -1;
+		}
+
+		int lastRow = -2;
+		for (int dy = 0; dy < dstHeight; dy++)
+		{
+			uchar* outLine = dst + dy * dstStride;
+
+			int sy = static_cast<int>(std::floor(y + (dy + 0.5) * scaleY));
+			if (sy < 0 || sy >= srcHeight) sy = -1;
+
+			//upscaled rows repeat - copy the previous destination line
+			if (sy == lastRow && dy > 0)
+			{
+				std::memcpy(outLine, outLine - dstStride, dstWidth * sizeof(quint32));
+				continue;
+			}
+			lastRow = sy;
+
+			quint32* out = reinterpret_cast<quint32*>(outLine);
+			if (sy < 0)
+			{
+				std::memset(out, 0, dstWidth * sizeof(quint32));
+				continue;
+			}
+
+			const quint32* in = reinterpret_cast<const quint32*>(src + sy * srcStride);
+			const int* column = columns.data();
+			for (int dx = 0; dx < dstWidth; dx++)
+			{
+				out[dx] = column[dx] < 0 ? 0u : in[column[dx]];
+			}
+		}
+	}
+}
+
+
+void scaleWaterfallImage(const uchar* src, int srcWidth, int srcHeight, int srcStride,
+	double x, double y, double width, double height,
+	uchar* dst, int dstWidth, int dstHeight, int dstStride)
+{
+	if (!src || !dst || dstWidth <= 0 || dstHeight <= 0 || width <= 0.0 || height <= 0.0) return;
+
+	int x0, y0, kx, ky;
+	const bool isBox = isInteger(x, x0) && isInteger(y, y0)
+		&& isInteger(width / dstWidth, kx) && isInteger(height / dstHeight, ky)
+		&& kx >= 1 && ky >= 1 && kx * ky > 1
+		&& x0 >= 0 && y0 >= 0
+		&& x0 + kx * dstWidth <= srcWidth && y0 + ky * dstHeight <= srcHeight;
+
+	if (isBox)
+	{
+		scaleBox(src, srcStride, x0, y0, kx, ky, dst, dstWidth, dstHeight, dstStride);
+	}
+	else
+	{
+		scaleNearest(src, srcWidth, srcHeight, srcStride, x, y, width, height, dst, dstWidth, dstHeight, dstStride);
+	}
+}
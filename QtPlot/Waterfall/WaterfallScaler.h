@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QtGlobal>
+
+
+/*!
+\brief Software scaler for the direct blit path of the waterfall
+
+Scales the region [x, x + width) x [y, y + height) of a 32 bit source image into
+the whole destination. Integer downscale ratios use a box filter, everything else
+uses nearest neighbour. Pixels outside of the source are set to 0 (transparent).
+
+\param src First scan line of the source.
+\param srcWidth Width of the source in pixels.
+\param srcHeight Height of the source in pixels.
+\param srcStride Bytes per line of the source.
+\param dst First scan line of the destination.
+\param dstWidth Width of the destination in pixels.
+\param dstHeight Height of the destination in pixels.
+\param dstStride Bytes per line of the destination.
+*/
+void scaleWaterfallImage(const uchar* src, int srcWidth, int srcHeight, int srcStride,
+	double x, double y, double width, double height,
+	uchar* dst, int dstWidth, int dstHeight, int dstStride);
@@ -0,0 +1,25 @@
+#include "WaterfallSnapshot.h"
+
+#include <cstring>
+
+
+const double* WaterfallSnapshot::row(int index) const
+{
+	if (index < 0 || index >= rowCount || ringRows <= 0) return nullptr;
+
+	const int slot = (firstRow + index) % ringRows;
+	return ring.at(slot).constData();
+}
+
+QVector<double> WaterfallSnapshot::data() const
+{
+	if (!hasData()) return QVector<double>();
+
+	QVector<double> result(rowCount * width);
+	for (int index = 0; index < rowCount; index++)
+	{
+		std::memcpy(result.data() + static_cast<qint64>(index) * width, row(index), sizeof(double) * width);
+	}
+
+	return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+#include "Interval.h"
+
+
+/*!
+\brief Snapshot of the waterfall content
+
+The image is a copy of the waterfall image.
+For WaterfallWithMemory the value history is shared with the content row by row in its ring
+buffer layout, row() and data() return it in time order (row 0 is the oldest).
+Rows appended after the snapshot replace the shared rows in the content and are not seen.
+*/
+class QTPLOT_EXPORT WaterfallSnapshot
+{
+public:
+	QImage		image;
+	QtInterval	interval;
+
+	QVector<QVector<double>>	ring;
+	int				width = 0;
+	int				ringRows = 0;
+	int				firstRow = 0;
+	int				rowCount = 0;
+
+public:
+	inline bool hasData() const { return rowCount > 0 && width > 0; }
+
+	const double* row(int index) const;
+	QVector<double> data() const;
+};
@@ -1,5 +1,6 @@
 #include "WaterfallThread.h"
 #include "WaterfallContent.h"
+#include "WaterfallProfiler.h"
 
 
 WaterfallThread::WaterfallThread(QObject* object)
@@ -55,6 +56,8 @@ void WaterfallThread::run()
 
 			if (bIsAppend)
 			{
+				WF_PROFILE_RECORD(content->getProfiler(), EWS_QueueWait, queueTimer.nsecsElapsed());
+
 				content->append(data, size, bIsAuto);
 
 				if (bIsAuto)
@@ -145,10 +148,12 @@ void WaterfallThread::addData(double* inData, int inSize)
 
 	if(data)
 	{
+		WF_PROFILE_SCOPE(content->getProfiler(), EWS_Copy);
 		memcpy(data, inData, size * sizeof(double));
 	}
 
 	bIsAppend = true;
+	WF_PROFILE_TIMER_START(queueTimer);
 
 	emit copyingCompleted();
 	appendMutex.unlock();
@@ -3,11 +3,11 @@
 #include <QThread>
 #include <QMutex>
 #include <qreadwritelock.h>
+#include <QElapsedTimer>
 
 
 //forward declaration
 class WaterfallContent;
-class QElapsedTimer;
 
 
 class WaterfallThread : public QThread
@@ -50,6 +50,10 @@ private:
 	qint64			frameDeltaTime;
 	QElapsedTimer*	frameTimer;
 
+#ifdef QTPLOT_WATERFALL_PROFILING
+	QElapsedTimer	queueTimer;
+#endif
+
 	double* data;
 	int		size;
 
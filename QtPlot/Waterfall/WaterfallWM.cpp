@@ -7,7 +7,7 @@ WaterfallWithMemory::WaterfallWithMemory(QWidget* parent)
 : WaterfallBase(parent)
 {
 	content = new WaterfallContentWithMemory(this);
-	content->createLayer(200, 200, 0, 0, 100, 100, 0, 100, QImage::Format_ARGB32, Qt::white);
+	content->createLayer(200, 200, 0, 0, 100, 100, 0, 100, QImage::Format_ARGB32_Premultiplied, Qt::white);
 	content->setColorMap(new WaterfallColorMap());
 	content->setLayer(WATERFALL_LAYER_NAME);
 